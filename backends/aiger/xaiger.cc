@@ -62,16 +62,16 @@ inline int32_t to_big_endian(int32_t i32) {
 #endif
 }
 
-void aiger_encode(std::ostream &f, int x)
+void aiger_encode(std::string &buffer, int x)
 {
 	log_assert(x >= 0);
 
 	while (x & ~0x7f) {
-		f.put((x & 0x7f) | 0x80);
+		buffer.push_back((x & 0x7f) | 0x80);
 		x = x >> 7;
 	}
 
-	f.put(x);
+	buffer.push_back(x);
 }
 
 struct XAigerWriter
@@ -93,14 +93,21 @@ struct XAigerWriter
 	int aig_m = 0, aig_i = 0, aig_l = 0, aig_o = 0, aig_a = 0;
 
 	dict<SigBit, int> aig_map;
+	dict<pair<int, int>, int> aig_strash;
 	dict<SigBit, int> ordered_outputs;
 
 	vector<Cell*> box_list;
 
 	int mkgate(int a0, int a1)
 	{
+		pair<int, int> key = a0 > a1 ? make_pair(a0, a1) : make_pair(a1, a0);
+		auto it = aig_strash.find(key);
+		if (it != aig_strash.end())
+			return it->second;
+
 		aig_m++, aig_a++;
-		aig_gates.push_back(a0 > a1 ? make_pair(a0, a1) : make_pair(a1, a0));
+		aig_gates.push_back(key);
+		aig_strash[key] = 2*aig_m;
 		return 2*aig_m;
 	}
 
@@ -112,31 +119,63 @@ struct XAigerWriter
 			return it->second;
 		}
 
-		// NB: Cannot use iterator returned from aig_map.insert()
-		//     since this function is called recursively
-
-		int a = -1;
-		if (not_map.count(bit)) {
-			a = bit2aig(not_map.at(bit)) ^ 1;
-		} else
-		if (and_map.count(bit)) {
-			auto args = and_map.at(bit);
-			int a0 = bit2aig(args.first);
-			int a1 = bit2aig(args.second);
-			a = mkgate(a0, a1);
-		} else
-		if (alias_map.count(bit)) {
-			a = bit2aig(alias_map.at(bit));
-		}
+		// Iterative depth-first walk, so deep logic cannot overflow the call
+		// stack. Inputs are visited in the same order as a recursive walk
+		// would, and the stack holds exactly the current path.
+		vector<SigBit> stack;
+		pool<SigBit> on_stack;
+		auto visit = [&](SigBit arg, int &lit) {
+			auto arg_it = aig_map.find(arg);
+			if (arg_it != aig_map.end()) {
+				log_assert(arg_it->second >= 0);
+				lit = arg_it->second;
+				return true;
+			}
+			if (!on_stack.insert(arg).second)
+				log_error("Found combinational loop through signal %s.\n", log_signal(arg));
+			stack.push_back(arg);
+			return false;
+		};
+
+		stack.push_back(bit);
+		on_stack.insert(bit);
 
-		if (bit == State::Sx || bit == State::Sz) {
-			log_debug("Design contains 'x' or 'z' bits. Treating as 1'b0.\n");
-			a = aig_map.at(State::S0);
+		while (!stack.empty())
+		{
+			SigBit b = stack.back();
+			int a = -1;
+
+			auto not_it = not_map.find(b);
+			auto and_it = and_map.find(b);
+			auto alias_it = alias_map.find(b);
+			if (not_it != not_map.end()) {
+				if (!visit(not_it->second, a))
+					continue;
+				a ^= 1;
+			} else
+			if (and_it != and_map.end()) {
+				int a0, a1;
+				if (!visit(and_it->second.first, a0) || !visit(and_it->second.second, a1))
+					continue;
+				a = mkgate(a0, a1);
+			} else
+			if (alias_it != alias_map.end()) {
+				if (!visit(alias_it->second, a))
+					continue;
+			}
+
+			if (b == State::Sx || b == State::Sz) {
+				log_debug("Design contains 'x' or 'z' bits. Treating as 1'b0.\n");
+				a = aig_map.at(State::S0);
+			}
+
+			log_assert(a >= 0);
+			aig_map[b] = a;
+			on_stack.erase(b);
+			stack.pop_back();
 		}
 
-		log_assert(a >= 0);
-		aig_map[bit] = a;
-		return a;
+		return aig_map.at(bit);
 	}
 
 	XAigerWriter(Module *module, bool dff_mode) : design(module->design), module(module), sigmap(module)
@@ -524,15 +563,24 @@ struct XAigerWriter
 			for (int i = aig_obcj; i < aig_obcjf; i++)
 				f << stringf("%d\n", aig_outputs.at(i));
 
+			// Encode the AND gates into a buffer that is written in large
+			// blocks, instead of putting every byte through the ostream.
+			std::string buffer;
+			buffer.reserve(1 << 20);
 			for (int i = 0; i < aig_a; i++) {
 				int lhs = 2*(aig_i+aig_l+i)+2;
-				int rhs0 = aig_gates.at(i).first;
-				int rhs1 = aig_gates.at(i).second;
+				int rhs0 = aig_gates[i].first;
+				int rhs1 = aig_gates[i].second;
 				int delta0 = lhs - rhs0;
 				int delta1 = rhs0 - rhs1;
-				aiger_encode(f, delta0);
-				aiger_encode(f, delta1);
+				aiger_encode(buffer, delta0);
+				aiger_encode(buffer, delta1);
+				if (GetSize(buffer) >= (1 << 20) - 10) {
+					f.write(buffer.data(), buffer.size());
+					buffer.clear();
+				}
 			}
+			f.write(buffer.data(), buffer.size());
 		}
 
 		f << "c";
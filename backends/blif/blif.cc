@@ -88,46 +88,124 @@ struct BlifDumper
 
 	pool<SigBit> cstr_bits_seen;
 
-	const std::string str(RTLIL::IdString id)
+	// The netlist is rendered into a single buffer that is handed to the
+	// output stream in large blocks. Net and port names are escaped once
+	// and then looked up, as they are repeated for every gate.
+	std::string buf;
+	dict<SigBit, std::string> net_names;
+	dict<IdString, std::string> id_names;
+
+	struct GateInfo {
+		bool latch;
+		const char *text;
+		std::vector<IdString> ports;
+	};
+
+	// Fine-grained cells written as .names (input ports, output port and
+	// cover rows) or .latch (D, Q, control port and latch type).
+	static const dict<IdString, GateInfo> &gate_info()
+	{
+		static dict<IdString, GateInfo> info;
+		if (info.empty()) {
+			info[ID($_NOT_)] = {false, "0 1\n", {ID::A, ID::Y}};
+			info[ID($_AND_)] = {false, "11 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_OR_)] = {false, "1- 1\n-1 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_XOR_)] = {false, "10 1\n01 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_NAND_)] = {false, "0- 1\n-0 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_NOR_)] = {false, "00 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_XNOR_)] = {false, "11 1\n00 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_ANDNOT_)] = {false, "10 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_ORNOT_)] = {false, "1- 1\n-0 1\n", {ID::A, ID::B, ID::Y}};
+			info[ID($_AOI3_)] = {false, "-00 1\n0-0 1\n", {ID::A, ID::B, ID::C, ID::Y}};
+			info[ID($_OAI3_)] = {false, "00- 1\n--0 1\n", {ID::A, ID::B, ID::C, ID::Y}};
+			info[ID($_AOI4_)] = {false, "-0-0 1\n-00- 1\n0--0 1\n0-0- 1\n", {ID::A, ID::B, ID::C, ID::D, ID::Y}};
+			info[ID($_OAI4_)] = {false, "00-- 1\n--00 1\n", {ID::A, ID::B, ID::C, ID::D, ID::Y}};
+			info[ID($_MUX_)] = {false, "1-0 1\n-11 1\n", {ID::A, ID::B, ID::S, ID::Y}};
+			info[ID($_NMUX_)] = {false, "0-0 1\n-01 1\n", {ID::A, ID::B, ID::S, ID::Y}};
+			info[ID($_FF_)] = {true, nullptr, {ID::D, ID::Q}};
+			info[ID($_DFF_N_)] = {true, "fe", {ID::D, ID::Q, ID::C}};
+			info[ID($_DFF_P_)] = {true, "re", {ID::D, ID::Q, ID::C}};
+			info[ID($_DLATCH_N_)] = {true, "al", {ID::D, ID::Q, ID::E}};
+			info[ID($_DLATCH_P_)] = {true, "ah", {ID::D, ID::Q, ID::E}};
+		}
+		return info;
+	}
+
+	static std::string escape_name(std::string str)
 	{
-		std::string str = RTLIL::unescape_id(id);
 		for (size_t i = 0; i < str.size(); i++)
 			if (str[i] == '#' || str[i] == '=' || str[i] == '<' || str[i] == '>')
 				str[i] = '?';
 		return str;
 	}
 
-	const std::string str(RTLIL::SigBit sig)
+	const std::string str(RTLIL::IdString id)
+	{
+		return escape_name(RTLIL::unescape_id(id));
+	}
+
+	void append_id(RTLIL::IdString id)
+	{
+		auto it = id_names.find(id);
+		if (it != id_names.end()) {
+			buf += it->second;
+			return;
+		}
+
+		std::string name = str(id);
+		buf += name;
+		id_names[id] = std::move(name);
+	}
+
+	void append_net(RTLIL::SigBit sig)
 	{
-		cstr_bits_seen.insert(sig);
+		if (config->noalias_mode)
+			cstr_bits_seen.insert(sig);
 
 		if (sig.wire == NULL) {
-			if (sig == RTLIL::State::S0) return config->false_type == "-" || config->false_type == "+" ? config->false_out.c_str() : "$false";
-			if (sig == RTLIL::State::S1) return config->true_type == "-" || config->true_type == "+" ? config->true_out.c_str() : "$true";
-			return config->undef_type == "-" || config->undef_type == "+" ? config->undef_out.c_str() : "$undef";
+			if (sig == RTLIL::State::S0)
+				buf += config->false_type == "-" || config->false_type == "+" ? config->false_out : "$false";
+			else if (sig == RTLIL::State::S1)
+				buf += config->true_type == "-" || config->true_type == "+" ? config->true_out : "$true";
+			else
+				buf += config->undef_type == "-" || config->undef_type == "+" ? config->undef_out : "$undef";
+			return;
 		}
 
-		std::string str = RTLIL::unescape_id(sig.wire->name);
-		for (size_t i = 0; i < str.size(); i++)
-			if (str[i] == '#' || str[i] == '=' || str[i] == '<' || str[i] == '>')
-				str[i] = '?';
+		auto it = net_names.find(sig);
+		if (it != net_names.end()) {
+			buf += it->second;
+			return;
+		}
 
-		if (sig.wire->width != 1)
-			str += stringf("[%d]", sig.wire->upto ? sig.wire->start_offset+sig.wire->width-sig.offset-1 : sig.wire->start_offset+sig.offset);
+		std::string name = escape_name(RTLIL::unescape_id(sig.wire->name));
+		if (sig.wire->width != 1) {
+			name += '[';
+			name += std::to_string(sig.wire->upto ? sig.wire->start_offset+sig.wire->width-sig.offset-1 : sig.wire->start_offset+sig.offset);
+			name += ']';
+		}
 
-		return str;
+		buf += name;
+		net_names[sig] = std::move(name);
 	}
 
-	const std::string str_init(RTLIL::SigBit sig)
+	void append_init(RTLIL::SigBit sig)
 	{
 		sigmap.apply(sig);
 
-		if (init_bits.count(sig) == 0)
-			return " 2";
-
-		string str = stringf(" %d", init_bits.at(sig));
+		auto it = init_bits.find(sig);
+		if (it == init_bits.end())
+			buf += " 2";
+		else
+			buf += it->second ? " 1" : " 0";
+	}
 
-		return str;
+	void flush_buffer(bool force = false)
+	{
+		if (force || GetSize(buf) >= (1 << 20)) {
+			f.write(buf.data(), buf.size());
+			buf.clear();
+		}
 	}
 
 	const char *subckt_or_gate(std::string cell_type)
@@ -144,27 +222,30 @@ struct BlifDumper
 	void dump_params(const char *command, dict<IdString, Const> &params)
 	{
 		for (auto &param : params) {
-			f << stringf("%s %s ", command, log_id(param.first));
+			buf += stringf("%s %s ", command, log_id(param.first));
 			if (param.second.flags & RTLIL::CONST_FLAG_STRING) {
 				std::string str = param.second.decode_string();
-				f << stringf("\"");
+				buf += '"';
 				for (char ch : str)
 					if (ch == '"' || ch == '\\')
-						f << stringf("\\%c", ch);
+						buf += stringf("\\%c", ch);
 					else if (ch < 32 || ch >= 127)
-						f << stringf("\\%03o", ch);
+						buf += stringf("\\%03o", ch);
 					else
-						f << stringf("%c", ch);
-				f << stringf("\"\n");
-			} else
-				f << stringf("%s\n", param.second.as_string().c_str());
+						buf += ch;
+				buf += "\"\n";
+			} else {
+				buf += param.second.as_string();
+				buf += '\n';
+			}
 		}
 	}
 
 	void dump()
 	{
-		f << stringf("\n");
-		f << stringf(".model %s\n", str(module->name).c_str());
+		buf += "\n.model ";
+		buf += str(module->name);
+		buf += '\n';
 
 		std::map<int, RTLIL::Wire*> inputs, outputs;
 
@@ -175,212 +256,133 @@ struct BlifDumper
 				outputs[wire->port_id] = wire;
 		}
 
-		f << stringf(".inputs");
+		buf += ".inputs";
 		for (auto &it : inputs) {
 			RTLIL::Wire *wire = it.second;
-			for (int i = 0; i < wire->width; i++)
-				f << stringf(" %s", str(RTLIL::SigSpec(wire, i)).c_str());
+			for (int i = 0; i < wire->width; i++) {
+				buf += ' ';
+				append_net(SigBit(wire, i));
+			}
 		}
-		f << stringf("\n");
+		buf += '\n';
 
-		f << stringf(".outputs");
+		buf += ".outputs";
 		for (auto &it : outputs) {
 			RTLIL::Wire *wire = it.second;
-			for (int i = 0; i < wire->width; i++)
-				f << stringf(" %s", str(RTLIL::SigSpec(wire, i)).c_str());
+			for (int i = 0; i < wire->width; i++) {
+				buf += ' ';
+				append_net(SigBit(wire, i));
+			}
 		}
-		f << stringf("\n");
+		buf += '\n';
 
 		if (module->get_blackbox_attribute()) {
-			f << stringf(".blackbox\n");
-			f << stringf(".end\n");
+			buf += ".blackbox\n";
+			buf += ".end\n";
+			flush_buffer(true);
 			return;
 		}
 
 		if (!config->impltf_mode) {
 			if (!config->false_type.empty()) {
 				if (config->false_type == "+")
-					f << stringf(".names %s\n", config->false_out.c_str());
+					buf += stringf(".names %s\n", config->false_out.c_str());
 				else if (config->false_type != "-")
-					f << stringf(".%s %s %s=$false\n", subckt_or_gate(config->false_type),
+					buf += stringf(".%s %s %s=$false\n", subckt_or_gate(config->false_type),
 							config->false_type.c_str(), config->false_out.c_str());
 			} else
-				f << stringf(".names $false\n");
+				buf += ".names $false\n";
 			if (!config->true_type.empty()) {
 				if (config->true_type == "+")
-					f << stringf(".names %s\n1\n", config->true_out.c_str());
+					buf += stringf(".names %s\n1\n", config->true_out.c_str());
 				else if (config->true_type != "-")
-					f << stringf(".%s %s %s=$true\n", subckt_or_gate(config->true_type),
+					buf += stringf(".%s %s %s=$true\n", subckt_or_gate(config->true_type),
 							config->true_type.c_str(), config->true_out.c_str());
 			} else
-				f << stringf(".names $true\n1\n");
+				buf += ".names $true\n1\n";
 			if (!config->undef_type.empty()) {
 				if (config->undef_type == "+")
-					f << stringf(".names %s\n", config->undef_out.c_str());
+					buf += stringf(".names %s\n", config->undef_out.c_str());
 				else if (config->undef_type != "-")
-					f << stringf(".%s %s %s=$undef\n", subckt_or_gate(config->undef_type),
+					buf += stringf(".%s %s %s=$undef\n", subckt_or_gate(config->undef_type),
 							config->undef_type.c_str(), config->undef_out.c_str());
 			} else
-				f << stringf(".names $undef\n");
+				buf += ".names $undef\n";
 		}
 
+		const dict<IdString, GateInfo> &gates = gate_info();
+
 		for (auto cell : module->cells())
 		{
+			flush_buffer();
+
 			if (config->unbuf_types.count(cell->type)) {
 				auto portnames = config->unbuf_types.at(cell->type);
-				f << stringf(".names %s %s\n1 1\n",
-						str(cell->getPort(portnames.first)).c_str(), str(cell->getPort(portnames.second)).c_str());
+				buf += ".names ";
+				append_net(cell->getPort(portnames.first));
+				buf += ' ';
+				append_net(cell->getPort(portnames.second));
+				buf += "\n1 1\n";
 				continue;
 			}
 
-			if (!config->icells_mode && cell->type == ID($_NOT_)) {
-				f << stringf(".names %s %s\n0 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_AND_)) {
-				f << stringf(".names %s %s %s\n11 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_OR_)) {
-				f << stringf(".names %s %s %s\n1- 1\n-1 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_XOR_)) {
-				f << stringf(".names %s %s %s\n10 1\n01 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_NAND_)) {
-				f << stringf(".names %s %s %s\n0- 1\n-0 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_NOR_)) {
-				f << stringf(".names %s %s %s\n00 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_XNOR_)) {
-				f << stringf(".names %s %s %s\n11 1\n00 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_ANDNOT_)) {
-				f << stringf(".names %s %s %s\n10 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_ORNOT_)) {
-				f << stringf(".names %s %s %s\n1- 1\n-0 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_AOI3_)) {
-				f << stringf(".names %s %s %s %s\n-00 1\n0-0 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::C)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_OAI3_)) {
-				f << stringf(".names %s %s %s %s\n00- 1\n--0 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(), str(cell->getPort(ID::C)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_AOI4_)) {
-				f << stringf(".names %s %s %s %s %s\n-0-0 1\n-00- 1\n0--0 1\n0-0- 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(),
-						str(cell->getPort(ID::C)).c_str(), str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_OAI4_)) {
-				f << stringf(".names %s %s %s %s %s\n00-- 1\n--00 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(),
-						str(cell->getPort(ID::C)).c_str(), str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_MUX_)) {
-				f << stringf(".names %s %s %s %s\n1-0 1\n-11 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(),
-						str(cell->getPort(ID::S)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_NMUX_)) {
-				f << stringf(".names %s %s %s %s\n0-0 1\n-01 1\n",
-						str(cell->getPort(ID::A)).c_str(), str(cell->getPort(ID::B)).c_str(),
-						str(cell->getPort(ID::S)).c_str(), str(cell->getPort(ID::Y)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_FF_)) {
-				f << stringf(".latch %s %s%s\n", str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Q)).c_str(),
-						str_init(cell->getPort(ID::Q)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_DFF_N_)) {
-				f << stringf(".latch %s %s fe %s%s\n", str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Q)).c_str(),
-						str(cell->getPort(ID::C)).c_str(), str_init(cell->getPort(ID::Q)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_DFF_P_)) {
-				f << stringf(".latch %s %s re %s%s\n", str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Q)).c_str(),
-						str(cell->getPort(ID::C)).c_str(), str_init(cell->getPort(ID::Q)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_DLATCH_N_)) {
-				f << stringf(".latch %s %s al %s%s\n", str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Q)).c_str(),
-						str(cell->getPort(ID::E)).c_str(), str_init(cell->getPort(ID::Q)).c_str());
-				goto internal_cell;
-			}
-
-			if (!config->icells_mode && cell->type == ID($_DLATCH_P_)) {
-				f << stringf(".latch %s %s ah %s%s\n", str(cell->getPort(ID::D)).c_str(), str(cell->getPort(ID::Q)).c_str(),
-						str(cell->getPort(ID::E)).c_str(), str_init(cell->getPort(ID::Q)).c_str());
-				goto internal_cell;
+			if (!config->icells_mode) {
+				auto it = gates.find(cell->type);
+				if (it != gates.end()) {
+					const GateInfo &gate = it->second;
+					if (gate.latch) {
+						buf += ".latch ";
+						append_net(cell->getPort(gate.ports[0]));
+						buf += ' ';
+						append_net(cell->getPort(gate.ports[1]));
+						if (gate.text != nullptr) {
+							buf += ' ';
+							buf += gate.text;
+							buf += ' ';
+							append_net(cell->getPort(gate.ports[2]));
+						}
+						append_init(cell->getPort(gate.ports[1]));
+						buf += '\n';
+					} else {
+						buf += ".names";
+						for (auto port : gate.ports) {
+							buf += ' ';
+							append_net(cell->getPort(port));
+						}
+						buf += '\n';
+						buf += gate.text;
+					}
+					goto internal_cell;
+				}
 			}
 
 			if (!config->icells_mode && cell->type == ID($lut)) {
-				f << stringf(".names");
+				buf += ".names";
 				auto &inputs = cell->getPort(ID::A);
 				auto width = cell->parameters.at(ID::WIDTH).as_int();
 				log_assert(inputs.size() == width);
-				for (int i = width-1; i >= 0; i--)
-					f << stringf(" %s", str(inputs.extract(i, 1)).c_str());
+				for (int i = width-1; i >= 0; i--) {
+					buf += ' ';
+					append_net(inputs[i]);
+				}
 				auto &output = cell->getPort(ID::Y);
 				log_assert(output.size() == 1);
-				f << stringf(" %s", str(output).c_str());
-				f << stringf("\n");
+				buf += ' ';
+				append_net(output);
+				buf += '\n';
 				RTLIL::SigSpec mask = cell->parameters.at(ID::LUT);
 				for (int i = 0; i < (1 << width); i++)
 					if (mask[i] == State::S1) {
 						for (int j = width-1; j >= 0; j--) {
-							f << ((i>>j)&1 ? '1' : '0');
+							buf += ((i>>j)&1 ? '1' : '0');
 						}
-						f << " 1\n";
+						buf += " 1\n";
 					}
 				goto internal_cell;
 			}
 
 			if (!config->icells_mode && cell->type == ID($sop)) {
-				f << stringf(".names");
+				buf += ".names";
 				auto &inputs = cell->getPort(ID::A);
 				auto width = cell->parameters.at(ID::WIDTH).as_int();
 				auto depth = cell->parameters.at(ID::DEPTH).as_int();
@@ -388,30 +390,39 @@ struct BlifDumper
 				while (GetSize(table) < 2*width*depth)
 					table.push_back(State::S0);
 				log_assert(inputs.size() == width);
-				for (int i = 0; i < width; i++)
-					f << stringf(" %s", str(inputs.extract(i, 1)).c_str());
+				for (int i = 0; i < width; i++) {
+					buf += ' ';
+					append_net(inputs[i]);
+				}
 				auto &output = cell->getPort(ID::Y);
 				log_assert(output.size() == 1);
-				f << stringf(" %s", str(output).c_str());
-				f << stringf("\n");
+				buf += ' ';
+				append_net(output);
+				buf += '\n';
 				for (int i = 0; i < depth; i++) {
 					for (int j = 0; j < width; j++) {
 						bool pat0 = table.at(2*width*i + 2*j + 0) == State::S1;
 						bool pat1 = table.at(2*width*i + 2*j + 1) == State::S1;
-						if (pat0 && !pat1) f << "0";
-						else if (!pat0 && pat1) f << "1";
-						else f << "-";
+						if (pat0 && !pat1) buf += '0';
+						else if (!pat0 && pat1) buf += '1';
+						else buf += '-';
 					}
-					f << " 1\n";
+					buf += " 1\n";
 				}
 				goto internal_cell;
 			}
 
-			f << stringf(".%s %s", subckt_or_gate(cell->type.str()), str(cell->type).c_str());
+			buf += '.';
+			buf += subckt_or_gate(cell->type.str());
+			buf += ' ';
+			append_id(cell->type);
 			for (auto &conn : cell->connections())
 			{
 				if (conn.second.size() == 1) {
-					f << stringf(" %s=%s", str(conn.first).c_str(), str(conn.second[0]).c_str());
+					buf += ' ';
+					append_id(conn.first);
+					buf += '=';
+					append_net(conn.second[0]);
 					continue;
 				}
 
@@ -419,21 +430,35 @@ struct BlifDumper
 				Wire *w = m ? m->wire(conn.first) : nullptr;
 
 				if (w == nullptr) {
-					for (int i = 0; i < GetSize(conn.second); i++)
-						f << stringf(" %s[%d]=%s", str(conn.first).c_str(), i, str(conn.second[i]).c_str());
+					for (int i = 0; i < GetSize(conn.second); i++) {
+						buf += ' ';
+						append_id(conn.first);
+						buf += '[';
+						buf += std::to_string(i);
+						buf += "]=";
+						append_net(conn.second[i]);
+					}
 				} else {
 					for (int i = 0; i < std::min(GetSize(conn.second), GetSize(w)); i++) {
 						SigBit sig(w, i);
-						f << stringf(" %s[%d]=%s", str(conn.first).c_str(), sig.wire->upto ?
+						buf += ' ';
+						append_id(conn.first);
+						buf += '[';
+						buf += std::to_string(sig.wire->upto ?
 								sig.wire->start_offset+sig.wire->width-sig.offset-1 :
-								sig.wire->start_offset+sig.offset, str(conn.second[i]).c_str());
+								sig.wire->start_offset+sig.offset);
+						buf += "]=";
+						append_net(conn.second[i]);
 					}
 				}
 			}
-			f << stringf("\n");
+			buf += '\n';
 
-			if (config->cname_mode)
-				f << stringf(".cname %s\n", str(cell->name).c_str());
+			if (config->cname_mode) {
+				buf += ".cname ";
+				buf += str(cell->name);
+				buf += '\n';
+			}
 			if (config->attr_mode)
 				dump_params(".attr", cell->attributes);
 			if (config->param_mode)
@@ -441,8 +466,11 @@ struct BlifDumper
 
 			if (0) {
 		internal_cell:
-				if (config->iname_mode)
-					f << stringf(".cname %s\n", str(cell->name).c_str());
+				if (config->iname_mode) {
+					buf += ".cname ";
+					buf += str(cell->name);
+					buf += '\n';
+				}
 				if (config->iattr_mode)
 					dump_params(".attr", cell->attributes);
 			}
@@ -457,16 +485,33 @@ struct BlifDumper
 			if (config->noalias_mode && cstr_bits_seen.count(lhs_bit) == 0)
 				continue;
 
-			if (config->conn_mode)
-				f << stringf(".conn %s %s\n", str(rhs_bit).c_str(), str(lhs_bit).c_str());
-			else if (!config->buf_type.empty())
-				f << stringf(".%s %s %s=%s %s=%s\n", subckt_or_gate(config->buf_type), config->buf_type.c_str(),
-						config->buf_in.c_str(), str(rhs_bit).c_str(), config->buf_out.c_str(), str(lhs_bit).c_str());
-			else
-				f << stringf(".names %s %s\n1 1\n", str(rhs_bit).c_str(), str(lhs_bit).c_str());
+			if (config->conn_mode) {
+				buf += ".conn ";
+				append_net(rhs_bit);
+				buf += ' ';
+				append_net(lhs_bit);
+				buf += '\n';
+			} else if (!config->buf_type.empty()) {
+				buf += stringf(".%s %s %s=", subckt_or_gate(config->buf_type), config->buf_type.c_str(), config->buf_in.c_str());
+				append_net(rhs_bit);
+				buf += ' ';
+				buf += config->buf_out;
+				buf += '=';
+				append_net(lhs_bit);
+				buf += '\n';
+			} else {
+				buf += ".names ";
+				append_net(rhs_bit);
+				buf += ' ';
+				append_net(lhs_bit);
+				buf += "\n1 1\n";
+			}
+
+			flush_buffer();
 		}
 
-		f << stringf(".end\n");
+		buf += ".end\n";
+		flush_buffer(true);
 	}
 
 	static void dump(std::ostream &f, RTLIL::Module *module, RTLIL::Design *design, BlifDumperConfig &config)
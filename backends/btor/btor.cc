@@ -44,6 +44,7 @@ struct BtorWorker
 	bool single_bad;
 	bool cover_mode;
 	bool print_internal_names;
+	bool coi_mode;
 
 	int next_nid = 1;
 	int initstate_nid = -1;
@@ -63,6 +64,14 @@ struct BtorWorker
 	// SigSpec => <nid>
 	dict<SigSpec, int> sig_nid;
 
+	// slice/concat/extend nodes emitted for signal fragments, for reuse
+	dict<std::tuple<int, int, int>, int> slice_nids;
+	dict<pair<int, int>, int> concat_nids;
+	dict<std::tuple<int, int, bool>, int> extend_nids;
+
+	// <nid> of a slice-concat chain => (<nid>, <bitidx>) of the bits it is made of
+	dict<int, vector<pair<int, int>>> nid_origin;
+
 	// bit to driving cell
 	dict<SigBit, Cell*> bit_cell;
 
@@ -227,6 +236,30 @@ struct BtorWorker
 		return sorts_mem.at(key);
 	}
 
+	int get_slice_nid(int nid, int upper, int lower)
+	{
+		auto key = std::make_tuple(nid, upper, lower);
+		if (slice_nids.count(key) == 0) {
+			int sid = get_bv_sid(upper-lower+1);
+			int nid2 = next_nid++;
+			btorf("%d slice %d %d %d %d\n", nid2, sid, nid, upper, lower);
+			slice_nids[key] = nid2;
+		}
+		return slice_nids.at(key);
+	}
+
+	int get_concat_nid(int nid_upper, int nid_lower, int width)
+	{
+		auto key = make_pair(nid_upper, nid_lower);
+		if (concat_nids.count(key) == 0) {
+			int sid = get_bv_sid(width);
+			int nid = next_nid++;
+			btorf("%d concat %d %d %d\n", nid, sid, nid_upper, nid_lower);
+			concat_nids[key] = nid;
+		}
+		return concat_nids.at(key);
+	}
+
 	void add_nid_sig(int nid, const SigSpec &sig)
 	{
 		if (verbose)
@@ -1089,7 +1122,11 @@ struct BtorWorker
 					}
 				}
 
-				nidbits.push_back(bit_nid.at(bit));
+				auto nidbit = bit_nid.at(bit);
+				auto origin = nid_origin.find(nidbit.first);
+				if (origin != nid_origin.end())
+					nidbit = origin->second.at(nidbit.second);
+				nidbits.push_back(nidbit);
 			}
 
 			int width = 0;
@@ -1108,19 +1145,13 @@ struct BtorWorker
 
 				int nid3 = nid2;
 
-				if (lower != 0 || upper+1 != nid_width.at(nid2)) {
-					int sid = get_bv_sid(upper-lower+1);
-					nid3 = next_nid++;
-					btorf("%d slice %d %d %d %d\n", nid3, sid, nid2, upper, lower);
-				}
+				if (lower != 0 || upper+1 != nid_width.at(nid2))
+					nid3 = get_slice_nid(nid2, upper, lower);
 
 				int nid4 = nid3;
 
-				if (nid >= 0) {
-					int sid = get_bv_sid(width+upper-lower+1);
-					nid4 = next_nid++;
-					btorf("%d concat %d %d %d\n", nid4, sid, nid3, nid);
-				}
+				if (nid >= 0)
+					nid4 = get_concat_nid(nid3, nid, width+upper-lower+1);
 
 				width += upper-lower+1;
 				nid = nid4;
@@ -1128,6 +1159,8 @@ struct BtorWorker
 
 			sig_nid[sig] = nid;
 			nid_width[nid] = width;
+			if (!nidbits.empty() && nid != nidbits.front().first)
+				nid_origin[nid] = nidbits;
 		}
 
 		nid = sig_nid.at(sig);
@@ -1137,26 +1170,27 @@ struct BtorWorker
 		{
 			if (to_width < GetSize(sig))
 			{
-				int sid = get_bv_sid(to_width);
-				int nid2 = next_nid++;
-				btorf("%d slice %d %d %d 0\n", nid2, sid, nid, to_width-1);
-				nid = nid2;
+				nid = get_slice_nid(nid, to_width-1, 0);
 			}
 			else
 			{
-				int sid = get_bv_sid(to_width);
-				int nid2 = next_nid++;
-				btorf("%d %s %d %d %d\n", nid2, is_signed ? "sext" : "uext",
-						sid, nid, to_width - GetSize(sig));
-				nid = nid2;
+				auto key = std::make_tuple(nid, to_width, is_signed);
+				if (extend_nids.count(key) == 0) {
+					int sid = get_bv_sid(to_width);
+					int nid2 = next_nid++;
+					btorf("%d %s %d %d %d\n", nid2, is_signed ? "sext" : "uext",
+							sid, nid, to_width - GetSize(sig));
+					extend_nids[key] = nid2;
+				}
+				nid = extend_nids.at(key);
 			}
 		}
 
 		return nid;
 	}
 
-	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, string info_filename, string ywmap_filename) :
-			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names), info_filename(info_filename)
+	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, bool coi_mode, string info_filename, string ywmap_filename) :
+			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names), coi_mode(coi_mode), info_filename(info_filename)
 	{
 		if (!info_filename.empty())
 			infof("name %s\n", log_id(module));
@@ -1246,7 +1280,7 @@ struct BtorWorker
 
 		for (auto wire : module->wires())
 		{
-			if (!wire->port_id || !wire->port_output)
+			if (!wire->port_id || !wire->port_output || coi_mode)
 				continue;
 
 			btorf_push(stringf("output %s", log_id(wire)));
@@ -1328,7 +1362,7 @@ struct BtorWorker
 
 		for (auto wire : module->wires())
 		{
-			if (wire->port_id || wire->name[0] == '$')
+			if (wire->port_id || wire->name[0] == '$' || coi_mode)
 				continue;
 
 			btorf_push(stringf("wire %s", log_id(wire)));
@@ -1553,10 +1587,14 @@ struct BtorBackend : public Backend {
 		log("  -ywmap <filename>\n");
 		log("    Create a map file for conversion to and from Yosys witness traces\n");
 		log("\n");
+		log("  -coi\n");
+		log("    Only output the cone of influence of the assumptions and properties,\n");
+		log("    omitting output ports and named wires that do not affect them\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
-		bool verbose = false, single_bad = false, cover_mode = false, print_internal_names = false;
+		bool verbose = false, single_bad = false, cover_mode = false, print_internal_names = false, coi_mode = false;
 		string info_filename;
 		string ywmap_filename;
 
@@ -1595,6 +1633,10 @@ struct BtorBackend : public Backend {
 				ywmap_filename = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-coi") {
+				coi_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
@@ -1607,7 +1649,7 @@ struct BtorBackend : public Backend {
 		*f << stringf("; BTOR description generated by %s for module %s.\n",
 				yosys_version_str, log_id(topmod));
 
-		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, info_filename, ywmap_filename);
+		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, coi_mode, info_filename, ywmap_filename);
 
 		*f << stringf("; end of yosys output\n");
 	}
@@ -21,6 +21,7 @@
 #include "kernel/register.h"
 #include "kernel/sigtools.h"
 #include "kernel/utils.h"
+#include "kernel/graph.h"
 #include "kernel/celltypes.h"
 #include "kernel/mem.h"
 #include "kernel/log.h"
@@ -2671,27 +2672,71 @@ struct CxxrtlWorker {
 
 			// Construct a linear order of the flow graph that minimizes the amount of feedback arcs. A flow graph
 			// without feedback arcs can generally be evaluated in a single pass, i.e. it always requires only
-			// a single delta cycle.
-			Scheduler<FlowGraph::Node> scheduler;
-			dict<FlowGraph::Node*, Scheduler<FlowGraph::Node>::Vertex*, hash_ptr_ops> node_vertex_map;
-			for (auto node : flow.nodes)
-				node_vertex_map[node] = scheduler.add(node);
-			for (auto node_comb_def : flow.node_comb_defs) {
-				auto vertex = node_vertex_map[node_comb_def.first];
+			// a single delta cycle. Feedback arcs can only occur within strongly connected components, so the
+			// components are ordered topologically and the heuristic is only run within nontrivial ones. If there
+			// are none, the heuristic is run on the whole graph as before, which keeps the order unchanged.
+			IntGraph flow_graph(GetSize(flow.nodes));
+			dict<FlowGraph::Node*, int, hash_ptr_ops> node_index;
+			for (int i = 0; i < GetSize(flow.nodes); i++)
+				node_index[flow.nodes[i]] = i;
+			for (auto node_comb_def : flow.node_comb_defs)
 				for (auto wire : node_comb_def.second)
-					for (auto succ_node : flow.wire_uses[wire]) {
-						auto succ_vertex = node_vertex_map[succ_node];
-						vertex->succs.insert(succ_vertex);
-						succ_vertex->preds.insert(vertex);
+					for (auto succ_node : flow.wire_uses[wire])
+						flow_graph.add_edge(node_index.at(node_comb_def.first), node_index.at(succ_node));
+			flow_graph.build();
+
+			std::vector<int> component;
+			std::vector<std::vector<int>> component_nodes(flow_graph.scc(component));
+			for (int i = 0; i < GetSize(flow.nodes); i++)
+				component_nodes[component[i]].push_back(i);
+
+			std::vector<FlowGraph::Node*> scheduled_nodes;
+			if (GetSize(component_nodes) == GetSize(flow.nodes)) {
+				Scheduler<FlowGraph::Node> scheduler;
+				dict<FlowGraph::Node*, Scheduler<FlowGraph::Node>::Vertex*, hash_ptr_ops> node_vertex_map;
+				for (auto node : flow.nodes)
+					node_vertex_map[node] = scheduler.add(node);
+				for (auto node_comb_def : flow.node_comb_defs) {
+					auto vertex = node_vertex_map[node_comb_def.first];
+					for (auto wire : node_comb_def.second)
+						for (auto succ_node : flow.wire_uses[wire]) {
+							auto succ_vertex = node_vertex_map[succ_node];
+							vertex->succs.insert(succ_vertex);
+							succ_vertex->preds.insert(vertex);
+						}
+				}
+				for (auto vertex : scheduler.schedule())
+					scheduled_nodes.push_back(vertex->data);
+			} else {
+				for (int c = GetSize(component_nodes) - 1; c >= 0; c--) {
+					auto &members = component_nodes[c];
+					if (GetSize(members) == 1) {
+						scheduled_nodes.push_back(flow.nodes[members.front()]);
+						continue;
 					}
+					Scheduler<FlowGraph::Node> scheduler;
+					dict<int, Scheduler<FlowGraph::Node>::Vertex*> node_vertex_map;
+					for (int i : members)
+						node_vertex_map[i] = scheduler.add(flow.nodes[i]);
+					for (int i : members)
+						for (int k = flow_graph.first[i]; k < flow_graph.first[i+1]; k++) {
+							int j = flow_graph.succ[k];
+							if (component[j] != c)
+								continue;
+							auto vertex = node_vertex_map.at(i), succ_vertex = node_vertex_map.at(j);
+							vertex->succs.insert(succ_vertex);
+							succ_vertex->preds.insert(vertex);
+						}
+					for (auto vertex : scheduler.schedule())
+						scheduled_nodes.push_back(vertex->data);
+				}
 			}
 
 			// Find out whether the order includes any feedback arcs.
 			std::vector<FlowGraph::Node*> node_order;
 			pool<FlowGraph::Node*, hash_ptr_ops> evaluated_nodes;
 			pool<const RTLIL::Wire*> feedback_wires;
-			for (auto vertex : scheduler.schedule()) {
-				auto node = vertex->data;
+			for (auto node : scheduled_nodes) {
 				node_order.push_back(node);
 				// Any wire that is an output of node vo and input of node vi where vo is scheduled later than vi
 				// is a feedback wire. Feedback wires indicate apparent logic loops in the design, which may be
@@ -38,8 +38,9 @@ struct EdifNames
 {
 	int counter;
 	char delim_left, delim_right;
-	std::set<std::string> generated_names, used_names;
-	std::map<std::string, std::string> name_map;
+	// used_names only holds the names that look like generated ones, as only those can collide
+	pool<std::string> generated_names, used_names;
+	dict<std::string, std::string> name_map;
 
 	EdifNames() : counter(1), delim_left('['), delim_right(']') { }
 
@@ -52,8 +53,9 @@ struct EdifNames
 			return new_id != id ? stringf("(rename %s \"%s\")", new_id.c_str(), id.c_str()) : id;
 		}
 
-		if (name_map.count(id) > 0)
-			return name_map.at(id);
+		auto it = name_map.find(id);
+		if (it != name_map.end())
+			return it->second;
 		if (generated_names.count(id) > 0)
 			goto do_rename;
 		if (id == "GND" || id == "VCC")
@@ -71,7 +73,8 @@ struct EdifNames
 			goto do_rename;
 		}
 
-		used_names.insert(id);
+		if (is_generated_form(id))
+			used_names.insert(id);
 		return id;
 
 	do_rename:;
@@ -86,6 +89,29 @@ struct EdifNames
 		name_map[id] = gen_name;
 		return gen_name;
 	}
+
+	static bool is_generated_form(const std::string &id)
+	{
+		if (id.size() < 3 || id[0] != 'i' || id[1] != 'd')
+			return false;
+		for (size_t i = 2; i < id.size(); i++)
+			if (id[i] < '0' || id[i] > '9')
+				return false;
+		return true;
+	}
+};
+
+// A port reference joined to a net. Rendered to text only when the net is written,
+// which keeps the per-bit net table small for large netlists.
+struct EdifPortRef
+{
+	RTLIL::IdString port;
+	RTLIL::Cell *cell; // nullptr for ports of the module itself
+	int member; // -1 for single-bit ports
+	bool flag; // the reference drives the net (cell outputs) or is a module input
+
+	EdifPortRef(RTLIL::IdString port, RTLIL::Cell *cell, int member, bool flag) :
+			port(port), cell(cell), member(member), flag(flag) { }
 };
 
 struct EdifBackend : public Backend {
@@ -337,7 +363,28 @@ struct EdifBackend : public Backend {
 				continue;
 
 			SigMap sigmap(module);
-			std::map<RTLIL::SigSpec, std::set<std::pair<std::string, bool>>> net_join_db;
+			dict<RTLIL::SigBit, std::vector<EdifPortRef>> net_join_db;
+
+			auto portref_str = [&](const EdifPortRef &ref) {
+				if (ref.cell == nullptr) {
+					if (ref.member < 0)
+						return stringf("(portRef %s)", EDIF_REF(ref.port));
+					return stringf("(portRef (member %s %d))", EDIF_REF(ref.port), ref.member);
+				}
+				if (ref.member < 0)
+					return stringf("(portRef %s (instanceRef %s))", EDIF_REF(ref.port), EDIF_REF(ref.cell->name));
+				return stringf("(portRef (member %s %d) (instanceRef %s))", EDIF_REF(ref.port), ref.member, EDIF_REF(ref.cell->name));
+			};
+
+			// sorted and unique, in the order of the std::set<std::pair<std::string, bool>> this used to be
+			auto net_refs = [&](const RTLIL::SigBit &bit) {
+				std::vector<std::pair<std::string, bool>> refs;
+				for (auto &ref : net_join_db.at(bit))
+					refs.emplace_back(portref_str(ref), ref.flag);
+				std::sort(refs.begin(), refs.end());
+				refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+				return refs;
+			};
 
 			*f << stringf("    (cell %s\n", EDIF_DEF(module->name));
 			*f << stringf("      (cellType GENERIC)\n");
@@ -423,8 +470,8 @@ struct EdifBackend : public Backend {
 						for (auto &p : wire->attributes)
 							add_prop(p.first, p.second);
 					*f << ")\n";
-					RTLIL::SigSpec sig = sigmap(RTLIL::SigSpec(wire));
-					net_join_db[sig].insert(make_pair(stringf("(portRef %s)", EDIF_REF(wire->name)), wire->port_input));
+					RTLIL::SigBit sig = sigmap(RTLIL::SigBit(wire));
+					net_join_db[sig].emplace_back(wire->name, nullptr, -1, wire->port_input);
 				} else {
 					int b[2];
 					b[wire->upto ? 0 : 1] = wire->start_offset;
@@ -436,8 +483,8 @@ struct EdifBackend : public Backend {
 
 					*f << ")\n";
 					for (int i = 0; i < wire->width; i++) {
-						RTLIL::SigSpec sig = sigmap(RTLIL::SigSpec(wire, i));
-						net_join_db[sig].insert(make_pair(stringf("(portRef (member %s %d))", EDIF_REF(wire->name), GetSize(wire)-i-1), wire->port_input));
+						RTLIL::SigBit sig = sigmap(RTLIL::SigBit(wire, i));
+						net_join_db[sig].emplace_back(wire->name, nullptr, GetSize(wire)-i-1, wire->port_input);
 					}
 				}
 			}
@@ -463,11 +510,17 @@ struct EdifBackend : public Backend {
 				*f << stringf(")\n");
 				for (auto &p : cell->connections()) {
 					RTLIL::SigSpec sig = sigmap(p.second);
+					bool port_named = false;
 					for (int i = 0; i < GetSize(sig); i++)
 						if (sig[i].wire == NULL && sig[i] != RTLIL::State::S0 && sig[i] != RTLIL::State::S1)
 							log_warning("Bit %d of cell port %s.%s.%s driven by %s will be left unconnected in EDIF output.\n",
 									i, log_id(module), log_id(cell), log_id(p.first), log_signal(sig[i]));
 						else {
+							// assign EDIF names in the same order as when references were rendered right away
+							if (!port_named) {
+								EDIF_REF(p.first);
+								port_named = true;
+							}
 							int member_idx = GetSize(sig)-i-1;
 							auto m = design->module(cell->type);
 							int width = sig.size();
@@ -478,27 +531,35 @@ struct EdifBackend : public Backend {
 									width = GetSize(w);
 								}
 							}
-							if (width == 1)
-								net_join_db[sig[i]].insert(make_pair(stringf("(portRef %s (instanceRef %s))", EDIF_REF(p.first), EDIF_REF(cell->name)), cell->output(p.first)));
-							else {
-								net_join_db[sig[i]].insert(make_pair(stringf("(portRef (member %s %d) (instanceRef %s))",
-										EDIF_REF(p.first), member_idx, EDIF_REF(cell->name)), cell->output(p.first)));
-							}
+							net_join_db[sig[i]].emplace_back(p.first, cell, width == 1 ? -1 : member_idx, cell->output(p.first));
 						}
 				}
 			}
 
-			for (auto &it : net_join_db) {
-				RTLIL::SigBit sig = it.first;
+			// nets are written in the order of a std::map<RTLIL::SigSpec, ...> keyed by single bits,
+			// i.e. by SigSpec hash with ties broken by comparing the signals
+			std::vector<std::pair<unsigned int, RTLIL::SigBit>> net_order;
+			net_order.reserve(net_join_db.size());
+			for (auto &it : net_join_db)
+				net_order.emplace_back(RTLIL::SigSpec(it.first).hash(), it.first);
+			std::sort(net_order.begin(), net_order.end(), [](const std::pair<unsigned int, RTLIL::SigBit> &a, const std::pair<unsigned int, RTLIL::SigBit> &b) {
+				if (a.first != b.first)
+					return a.first < b.first;
+				return RTLIL::SigSpec(a.second) < RTLIL::SigSpec(b.second);
+			});
+
+			for (auto &net : net_order) {
+				RTLIL::SigBit sig = net.second;
+				auto refs = net_refs(sig);
 				if (sig.wire == NULL && sig != RTLIL::State::S0 && sig != RTLIL::State::S1) {
 					if (sig == RTLIL::State::Sx) {
-						for (auto &ref : it.second)
+						for (auto &ref : refs)
 							log_warning("Exporting x-bit on %s as zero bit.\n", ref.first.c_str());
 						sig = RTLIL::State::S0;
 					} else if (sig == RTLIL::State::Sz) {
 						continue;
 					} else {
-						for (auto &ref : it.second)
+						for (auto &ref : refs)
 							log_error("Don't know how to handle %s on %s.\n", log_signal(sig), ref.first.c_str());
 						log_abort();
 					}
@@ -515,7 +576,7 @@ struct EdifBackend : public Backend {
 							netname.erase(netname.begin() + i--);
 				}
 				*f << stringf("          (net %s (joined\n", EDIF_DEF(netname));
-				for (auto &ref : it.second)
+				for (auto &ref : refs)
 					*f << stringf("              %s\n", ref.first.c_str());
 				if (sig.wire == NULL) {
 					if (nogndvcc)
@@ -554,7 +615,7 @@ struct EdifBackend : public Backend {
 					{
 						*f << stringf("          (net %s (joined\n", EDIF_DEF(netname));
 
-						auto &refs = net_join_db.at(mapped_sig);
+						auto refs = net_refs(mapped_sig);
 						for (auto &ref : refs)
 							if (ref.second)
 								*f << stringf("              %s\n", ref.first.c_str());
@@ -80,8 +80,9 @@ string next_id()
 
 const char *make_id(IdString id)
 {
-	if (namecache.count(id) != 0)
-		return namecache.at(id).c_str();
+	auto it = namecache.find(id);
+	if (it != namecache.end())
+		return it->second.c_str();
 
 	string new_id = log_id(id);
 
@@ -369,6 +370,7 @@ struct FirrtlWorker
 	std::ostream &f;
 
 	dict<SigBit, pair<string, int>> reverse_wire_map;
+	dict<std::tuple<Wire*, int, int>, string> chunk_exprs;
 	string unconn_id;
 	RTLIL::Design *design;
 	std::string indent;
@@ -383,51 +385,79 @@ struct FirrtlWorker
 	{
 	}
 
-	static string make_expr(const SigSpec &sig)
+	// Builds "cat(e[n-1], cat(..., cat(e[1], e[0])))" in a single pass
+	// instead of re-copying the growing expression for every chunk.
+	static string make_cat_expr(const vector<string> &exprs)
 	{
+		if (exprs.empty())
+			return string();
+
+		size_t len = 0;
+		for (auto &e : exprs)
+			len += e.size() + 7;
+
 		string expr;
+		expr.reserve(len);
+		for (int i = GetSize(exprs)-1; i > 0; i--) {
+			expr += "cat(";
+			expr += exprs[i];
+			expr += ", ";
+		}
+		expr += exprs[0];
+		expr.append(GetSize(exprs)-1, ')');
+		return expr;
+	}
 
-		for (auto chunk : sig.chunks())
-		{
-			string new_expr;
+	static string make_const_expr(const SigChunk &chunk)
+	{
+		std::vector<RTLIL::State> bits = chunk.data;
+		string expr = stringf("UInt<%d>(\"h", GetSize(bits));
 
-			if (chunk.wire == nullptr)
-			{
-				std::vector<RTLIL::State> bits = chunk.data;
-				new_expr = stringf("UInt<%d>(\"h", GetSize(bits));
+		while (GetSize(bits) % 4 != 0)
+			bits.push_back(State::S0);
 
-				while (GetSize(bits) % 4 != 0)
-					bits.push_back(State::S0);
+		for (int i = GetSize(bits)-4; i >= 0; i -= 4)
+		{
+			int val = 0;
+			if (bits[i+0] == State::S1) val += 1;
+			if (bits[i+1] == State::S1) val += 2;
+			if (bits[i+2] == State::S1) val += 4;
+			if (bits[i+3] == State::S1) val += 8;
+			expr.push_back(val < 10 ? '0' + val : 'a' + val - 10);
+		}
 
-				for (int i = GetSize(bits)-4; i >= 0; i -= 4)
-				{
-					int val = 0;
-					if (bits[i+0] == State::S1) val += 1;
-					if (bits[i+1] == State::S1) val += 2;
-					if (bits[i+2] == State::S1) val += 4;
-					if (bits[i+3] == State::S1) val += 8;
-					new_expr.push_back(val < 10 ? '0' + val : 'a' + val - 10);
-				}
+		expr += "\")";
+		return expr;
+	}
 
-				new_expr += "\")";
-			}
-			else if (chunk.offset == 0 && chunk.width == chunk.wire->width)
-			{
-				new_expr = make_id(chunk.wire->name);
-			}
-			else
-			{
-				string wire_id = make_id(chunk.wire->name);
-				new_expr = stringf("bits(%s, %d, %d)", wire_id.c_str(), chunk.offset + chunk.width - 1, chunk.offset);
-			}
+	const string &make_chunk_expr(const SigChunk &chunk)
+	{
+		auto key = std::make_tuple(chunk.wire, chunk.offset, chunk.width);
+		auto it = chunk_exprs.find(key);
+		if (it != chunk_exprs.end())
+			return it->second;
+
+		string wire_id = make_id(chunk.wire->name);
+		if (chunk.offset == 0 && chunk.width == chunk.wire->width)
+			return chunk_exprs[key] = wire_id;
+		return chunk_exprs[key] = stringf("bits(%s, %d, %d)", wire_id.c_str(), chunk.offset + chunk.width - 1, chunk.offset);
+	}
 
-			if (expr.empty())
-				expr = new_expr;
+	string make_expr(const SigSpec &sig)
+	{
+		vector<string> exprs;
+
+		for (auto &chunk : sig.chunks())
+		{
+			if (chunk.wire == nullptr)
+				exprs.push_back(make_const_expr(chunk));
 			else
-				expr = "cat(" + new_expr + ", " + expr + ")";
+				exprs.push_back(make_chunk_expr(chunk));
 		}
 
-		return expr;
+		if (GetSize(exprs) == 1)
+			return std::move(exprs.front());
+		return make_cat_expr(exprs);
 	}
 
 	std::string fid(RTLIL::IdString internal_id)
@@ -1073,7 +1103,7 @@ struct FirrtlWorker
 
 		for (auto wire : module->wires())
 		{
-			string expr;
+			vector<string> exprs;
 			std::string wireFileinfo = getFileinfo(wire);
 
 			if (wire->port_input)
@@ -1086,32 +1116,30 @@ struct FirrtlWorker
 			while (cursor < wire->width)
 			{
 				int chunk_width = 1;
-				string new_expr;
 
-				SigBit start_bit(wire, cursor);
+				auto start_it = reverse_wire_map.find(SigBit(wire, cursor));
 
-				if (reverse_wire_map.count(start_bit))
+				if (start_it != reverse_wire_map.end())
 				{
-					pair<string, int> start_map = reverse_wire_map.at(start_bit);
+					const pair<string, int> &start_map = start_it->second;
 
 					while (cursor+chunk_width < wire->width)
 					{
-						SigBit stop_bit(wire, cursor+chunk_width);
+						auto stop_it = reverse_wire_map.find(SigBit(wire, cursor+chunk_width));
 
-						if (reverse_wire_map.count(stop_bit) == 0)
+						if (stop_it == reverse_wire_map.end())
 							break;
 
-						pair<string, int> stop_map = reverse_wire_map.at(stop_bit);
-						stop_map.second -= chunk_width;
+						const pair<string, int> &stop_map = stop_it->second;
 
-						if (start_map != stop_map)
+						if (stop_map.second - chunk_width != start_map.second || stop_map.first != start_map.first)
 							break;
 
 						chunk_width++;
 					}
 
-					new_expr = stringf("bits(%s, %d, %d)", start_map.first.c_str(),
-							start_map.second + chunk_width - 1, start_map.second);
+					exprs.push_back(stringf("bits(%s, %d, %d)", start_map.first.c_str(),
+							start_map.second + chunk_width - 1, start_map.second));
 					is_valid = true;
 				}
 				else
@@ -1120,17 +1148,14 @@ struct FirrtlWorker
 						unconn_id = next_id();
 						make_unconn_id = true;
 					}
-					new_expr = unconn_id;
+					exprs.push_back(unconn_id);
 				}
 
-				if (expr.empty())
-					expr = new_expr;
-				else
-					expr = "cat(" + new_expr + ", " + expr + ")";
-
 				cursor += chunk_width;
 			}
 
+			string expr = make_cat_expr(exprs);
+
 			if (is_valid) {
 				if (make_unconn_id) {
 					wire_decls.push_back(stringf("%swire %s: UInt<1> %s\n", indent.c_str(), unconn_id.c_str(), wireFileinfo.c_str()));
@@ -1151,30 +1176,30 @@ struct FirrtlWorker
 			}
 		}
 
-		for (auto str : port_decls)
+		for (auto &str : port_decls)
 			f << str;
 
-		f << stringf("\n");
+		f << "\n";
 
-		for (auto str : wire_decls)
+		for (auto &str : wire_decls)
 			f << str;
 
-		f << stringf("\n");
+		f << "\n";
 
-		for (auto str : mem_exprs)
+		for (auto &str : mem_exprs)
 			f << str;
 
-		f << stringf("\n");
+		f << "\n";
 
-		for (auto str : cell_exprs)
+		for (auto &str : cell_exprs)
 			f << str;
 
-		f << stringf("\n");
+		f << "\n";
 
-		for (auto str : wire_exprs)
+		for (auto &str : wire_exprs)
 			f << str;
 
-		f << stringf("\n");
+		f << "\n";
 	}
 
 	void run()
@@ -24,8 +24,13 @@
 
 #include "rtlil_backend.h"
 #include "kernel/yosys.h"
+#include "libs/sha1/sha1.h"
 #include <errno.h>
 
+#ifndef _WIN32
+#  include <sys/stat.h>
+#endif
+
 USING_YOSYS_NAMESPACE
 using namespace RTLIL_BACKEND;
 YOSYS_NAMESPACE_BEGIN
@@ -46,44 +51,46 @@ void RTLIL_BACKEND::dump_const(std::ostream &f, const RTLIL::Const &data, int wi
 				}
 			}
 			if (val >= 0) {
-				f << stringf("%d", val);
+				f << val;
 				return;
 			}
 		}
-		f << stringf("%d'", width);
+		f << width << '\'';
 		if (data.is_fully_undef_x_only()) {
 			f << "x";
 		} else {
-			for (int i = offset+width-1; i >= offset; i--) {
-				log_assert(i < (int)data.bits.size());
-				switch (data.bits[i]) {
-				case State::S0: f << stringf("0"); break;
-				case State::S1: f << stringf("1"); break;
-				case RTLIL::Sx: f << stringf("x"); break;
-				case RTLIL::Sz: f << stringf("z"); break;
-				case RTLIL::Sa: f << stringf("-"); break;
-				case RTLIL::Sm: f << stringf("m"); break;
+			log_assert(offset+width <= (int)data.bits.size());
+			std::string bits(width, '?');
+			for (int i = 0; i < width; i++) {
+				switch (data.bits[offset+i]) {
+				case State::S0: bits[width-1-i] = '0'; break;
+				case State::S1: bits[width-1-i] = '1'; break;
+				case RTLIL::Sx: bits[width-1-i] = 'x'; break;
+				case RTLIL::Sz: bits[width-1-i] = 'z'; break;
+				case RTLIL::Sa: bits[width-1-i] = '-'; break;
+				case RTLIL::Sm: bits[width-1-i] = 'm'; break;
 				}
 			}
+			f << bits;
 		}
 	} else {
-		f << stringf("\"");
+		f << "\"";
 		std::string str = data.decode_string();
 		for (size_t i = 0; i < str.size(); i++) {
 			if (str[i] == '\n')
-				f << stringf("\\n");
+				f << "\\n";
 			else if (str[i] == '\t')
-				f << stringf("\\t");
+				f << "\\t";
 			else if (str[i] < 32)
 				f << stringf("\\%03o", (unsigned char)str[i]);
 			else if (str[i] == '"')
-				f << stringf("\\\"");
+				f << "\\\"";
 			else if (str[i] == '\\')
-				f << stringf("\\\\");
+				f << "\\\\";
 			else
 				f << str[i];
 		}
-		f << stringf("\"");
+		f << "\"";
 	}
 }
 
@@ -93,11 +100,11 @@ void RTLIL_BACKEND::dump_sigchunk(std::ostream &f, const RTLIL::SigChunk &chunk,
 		dump_const(f, chunk.data, chunk.width, chunk.offset, autoint);
 	} else {
 		if (chunk.width == chunk.wire->width && chunk.offset == 0)
-			f << stringf("%s", chunk.wire->name.c_str());
+			f << chunk.wire->name.c_str();
 		else if (chunk.width == 1)
-			f << stringf("%s [%d]", chunk.wire->name.c_str(), chunk.offset);
+			f << chunk.wire->name.c_str() << " [" << chunk.offset << ']';
 		else
-			f << stringf("%s [%d:%d]", chunk.wire->name.c_str(), chunk.offset+chunk.width-1, chunk.offset);
+			f << chunk.wire->name.c_str() << " [" << chunk.offset+chunk.width-1 << ':' << chunk.offset << ']';
 	}
 }
 
@@ -106,12 +113,12 @@ void RTLIL_BACKEND::dump_sigspec(std::ostream &f, const RTLIL::SigSpec &sig, boo
 	if (sig.is_chunk()) {
 		dump_sigchunk(f, sig.as_chunk(), autoint);
 	} else {
-		f << stringf("{ ");
+		f << "{ ";
 		for (auto it = sig.chunks().rbegin(); it != sig.chunks().rend(); ++it) {
 			dump_sigchunk(f, *it, false);
-			f << stringf(" ");
+			f << " ";
 		}
-		f << stringf("}");
+		f << "}";
 	}
 }
 
@@ -120,13 +127,13 @@ void RTLIL_BACKEND::dump_wire(std::ostream &f, std::string indent, const RTLIL::
 	for (auto &it : wire->attributes) {
 		f << stringf("%s" "attribute %s ", indent.c_str(), it.first.c_str());
 		dump_const(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	f << stringf("%s" "wire ", indent.c_str());
 	if (wire->width != 1)
 		f << stringf("width %d ", wire->width);
 	if (wire->upto)
-		f << stringf("upto ");
+		f << "upto ";
 	if (wire->start_offset != 0)
 		f << stringf("offset %d ", wire->start_offset);
 	if (wire->port_input && !wire->port_output)
@@ -136,7 +143,7 @@ void RTLIL_BACKEND::dump_wire(std::ostream &f, std::string indent, const RTLIL::
 	if (wire->port_input && wire->port_output)
 		f << stringf("inout %d ", wire->port_id);
 	if (wire->is_signed)
-		f << stringf("signed ");
+		f << "signed ";
 	f << stringf("%s\n", wire->name.c_str());
 }
 
@@ -145,7 +152,7 @@ void RTLIL_BACKEND::dump_memory(std::ostream &f, std::string indent, const RTLIL
 	for (auto &it : memory->attributes) {
 		f << stringf("%s" "attribute %s ", indent.c_str(), it.first.c_str());
 		dump_const(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	f << stringf("%s" "memory ", indent.c_str());
 	if (memory->width != 1)
@@ -162,7 +169,7 @@ void RTLIL_BACKEND::dump_cell(std::ostream &f, std::string indent, const RTLIL::
 	for (auto &it : cell->attributes) {
 		f << stringf("%s" "attribute %s ", indent.c_str(), it.first.c_str());
 		dump_const(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	f << stringf("%s" "cell %s %s\n", indent.c_str(), cell->type.c_str(), cell->name.c_str());
 	for (auto &it : cell->parameters) {
@@ -171,12 +178,12 @@ void RTLIL_BACKEND::dump_cell(std::ostream &f, std::string indent, const RTLIL::
 				(it.second.flags & RTLIL::CONST_FLAG_REAL) != 0 ? " real" : "",
 				it.first.c_str());
 		dump_const(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	for (auto &it : cell->connections()) {
 		f << stringf("%s  connect %s ", indent.c_str(), it.first.c_str());
 		dump_sigspec(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	f << stringf("%s" "end\n", indent.c_str());
 }
@@ -187,9 +194,9 @@ void RTLIL_BACKEND::dump_proc_case_body(std::ostream &f, std::string indent, con
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, it->first);
-		f << stringf(" ");
+		f << " ";
 		dump_sigspec(f, it->second);
-		f << stringf("\n");
+		f << "\n";
 	}
 
 	for (auto it = cs->switches.begin(); it != cs->switches.end(); ++it)
@@ -201,27 +208,27 @@ void RTLIL_BACKEND::dump_proc_switch(std::ostream &f, std::string indent, const
 	for (auto it = sw->attributes.begin(); it != sw->attributes.end(); ++it) {
 		f << stringf("%s" "attribute %s ", indent.c_str(), it->first.c_str());
 		dump_const(f, it->second);
-		f << stringf("\n");
+		f << "\n";
 	}
 
 	f << stringf("%s" "switch ", indent.c_str());
 	dump_sigspec(f, sw->signal);
-	f << stringf("\n");
+	f << "\n";
 
 	for (auto it = sw->cases.begin(); it != sw->cases.end(); ++it)
 	{
 		for (auto ait = (*it)->attributes.begin(); ait != (*it)->attributes.end(); ++ait) {
 			f << stringf("%s  attribute %s ", indent.c_str(), ait->first.c_str());
 			dump_const(f, ait->second);
-			f << stringf("\n");
+			f << "\n";
 		}
 		f << stringf("%s  case ", indent.c_str());
 		for (size_t i = 0; i < (*it)->compare.size(); i++) {
 			if (i > 0)
-				f << stringf(" , ");
+				f << " , ";
 			dump_sigspec(f, (*it)->compare[i]);
 		}
-		f << stringf("\n");
+		f << "\n";
 
 		dump_proc_case_body(f, indent + "    ", *it);
 	}
@@ -233,42 +240,42 @@ void RTLIL_BACKEND::dump_proc_sync(std::ostream &f, std::string indent, const RT
 {
 	f << stringf("%s" "sync ", indent.c_str());
 	switch (sy->type) {
-	case RTLIL::ST0: f << stringf("low ");
-	if (0) case RTLIL::ST1: f << stringf("high ");
-	if (0) case RTLIL::STp: f << stringf("posedge ");
-	if (0) case RTLIL::STn: f << stringf("negedge ");
-	if (0) case RTLIL::STe: f << stringf("edge ");
+	case RTLIL::ST0: f << "low ";
+	if (0) case RTLIL::ST1: f << "high ";
+	if (0) case RTLIL::STp: f << "posedge ";
+	if (0) case RTLIL::STn: f << "negedge ";
+	if (0) case RTLIL::STe: f << "edge ";
 		dump_sigspec(f, sy->signal);
-		f << stringf("\n");
+		f << "\n";
 		break;
-	case RTLIL::STa: f << stringf("always\n"); break;
-	case RTLIL::STg: f << stringf("global\n"); break;
-	case RTLIL::STi: f << stringf("init\n"); break;
+	case RTLIL::STa: f << "always\n"; break;
+	case RTLIL::STg: f << "global\n"; break;
+	case RTLIL::STi: f << "init\n"; break;
 	}
 
 	for (auto &it: sy->actions) {
 		f << stringf("%s  update ", indent.c_str());
 		dump_sigspec(f, it.first);
-		f << stringf(" ");
+		f << " ";
 		dump_sigspec(f, it.second);
-		f << stringf("\n");
+		f << "\n";
 	}
 
 	for (auto &it: sy->mem_write_actions) {
 		for (auto it2 = it.attributes.begin(); it2 != it.attributes.end(); ++it2) {
 			f << stringf("%s  attribute %s ", indent.c_str(), it2->first.c_str());
 			dump_const(f, it2->second);
-			f << stringf("\n");
+			f << "\n";
 		}
 		f << stringf("%s  memwr %s ", indent.c_str(), it.memid.c_str());
 		dump_sigspec(f, it.address);
-		f << stringf(" ");
+		f << " ";
 		dump_sigspec(f, it.data);
-		f << stringf(" ");
+		f << " ";
 		dump_sigspec(f, it.enable);
-		f << stringf(" ");
+		f << " ";
 		dump_const(f, it.priority_mask);
-		f << stringf("\n");
+		f << "\n";
 	}
 }
 
@@ -277,7 +284,7 @@ void RTLIL_BACKEND::dump_proc(std::ostream &f, std::string indent, const RTLIL::
 	for (auto it = proc->attributes.begin(); it != proc->attributes.end(); ++it) {
 		f << stringf("%s" "attribute %s ", indent.c_str(), it->first.c_str());
 		dump_const(f, it->second);
-		f << stringf("\n");
+		f << "\n";
 	}
 	f << stringf("%s" "process %s\n", indent.c_str(), proc->name.c_str());
 	dump_proc_case_body(f, indent + "  ", &proc->root_case);
@@ -290,9 +297,9 @@ void RTLIL_BACKEND::dump_conn(std::ostream &f, std::string indent, const RTLIL::
 {
 	f << stringf("%s" "connect ", indent.c_str());
 	dump_sigspec(f, left);
-	f << stringf(" ");
+	f << " ";
 	dump_sigspec(f, right);
-	f << stringf("\n");
+	f << "\n";
 }
 
 void RTLIL_BACKEND::dump_module(std::ostream &f, std::string indent, RTLIL::Module *module, RTLIL::Design *design, bool only_selected, bool flag_m, bool flag_n)
@@ -305,14 +312,14 @@ void RTLIL_BACKEND::dump_module(std::ostream &f, std::string indent, RTLIL::Modu
 		for (auto it = module->attributes.begin(); it != module->attributes.end(); ++it) {
 			f << stringf("%s" "attribute %s ", indent.c_str(), it->first.c_str());
 			dump_const(f, it->second);
-			f << stringf("\n");
+			f << "\n";
 		}
 
 		f << stringf("%s" "module %s\n", indent.c_str(), module->name.c_str());
 
 		if (!module->avail_parameters.empty()) {
 			if (only_selected)
-				f << stringf("\n");
+				f << "\n";
 			for (const auto &p : module->avail_parameters) {
 				const auto &it = module->parameter_default_values.find(p);
 				if (it == module->parameter_default_values.end()) {
@@ -320,7 +327,7 @@ void RTLIL_BACKEND::dump_module(std::ostream &f, std::string indent, RTLIL::Modu
 				} else {
 					f << stringf("%s" "  parameter %s ", indent.c_str(), p.c_str());
 					dump_const(f, it->second);
-					f << stringf("\n");
+					f << "\n";
 				}
 			}
 		}
@@ -331,28 +338,28 @@ void RTLIL_BACKEND::dump_module(std::ostream &f, std::string indent, RTLIL::Modu
 		for (auto it : module->wires())
 			if (!only_selected || design->selected(module, it)) {
 				if (only_selected)
-					f << stringf("\n");
+					f << "\n";
 				dump_wire(f, indent + "  ", it);
 			}
 
 		for (auto it : module->memories)
 			if (!only_selected || design->selected(module, it.second)) {
 				if (only_selected)
-					f << stringf("\n");
+					f << "\n";
 				dump_memory(f, indent + "  ", it.second);
 			}
 
 		for (auto it : module->cells())
 			if (!only_selected || design->selected(module, it)) {
 				if (only_selected)
-					f << stringf("\n");
+					f << "\n";
 				dump_cell(f, indent + "  ", it);
 			}
 
 		for (auto it : module->processes)
 			if (!only_selected || design->selected(module, it.second)) {
 				if (only_selected)
-					f << stringf("\n");
+					f << "\n";
 				dump_proc(f, indent + "  ", it.second);
 			}
 
@@ -370,7 +377,7 @@ void RTLIL_BACKEND::dump_module(std::ostream &f, std::string indent, RTLIL::Modu
 			}
 			if (show_conn) {
 				if (only_selected && first_conn_line)
-					f << stringf("\n");
+					f << "\n";
 				dump_conn(f, indent + "  ", it->first, it->second);
 				first_conn_line = false;
 			}
@@ -399,14 +406,14 @@ void RTLIL_BACKEND::dump_design(std::ostream &f, RTLIL::Design *design, bool onl
 
 	if (!only_selected || flag_m) {
 		if (only_selected)
-			f << stringf("\n");
+			f << "\n";
 		f << stringf("autoidx %d\n", autoidx);
 	}
 
 	for (auto module : design->modules()) {
 		if (!only_selected || design->selected(module)) {
 			if (only_selected)
-				f << stringf("\n");
+				f << "\n";
 			dump_module(f, "", module, design, only_selected, flag_m, flag_n);
 		}
 	}
@@ -417,6 +424,71 @@ void RTLIL_BACKEND::dump_design(std::ostream &f, RTLIL::Design *design, bool onl
 YOSYS_NAMESPACE_END
 PRIVATE_NAMESPACE_BEGIN
 
+std::string split_module_filename(RTLIL::IdString name)
+{
+	std::string str = name.str();
+	if (str[0] == '\\')
+		str = str.substr(1);
+
+	bool sanitized = false;
+	for (auto &c : str)
+		if (!isalnum((unsigned char)c) && c != '_' && c != '$' && c != '.' && c != '-') {
+			c = '_';
+			sanitized = true;
+		}
+	// keep names that only differ in replaced characters apart
+	if (sanitized)
+		str += "_" + sha1(name.str()).substr(0, 8);
+	return str + ".il";
+}
+
+// One past the largest index that NEW_ID-style names ("...$<n>") in the module
+// use, so that the file of a module only changes when the module changes.
+int split_module_autoidx(RTLIL::Module *module)
+{
+	int max_idx = 0;
+	auto scan = [&](RTLIL::IdString id) {
+		if (id.isPublic())
+			return;
+		const std::string &str = id.str();
+		size_t pos = str.rfind('$');
+		if (pos == 0 || pos + 1 == str.size() || str.size() - pos > 10)
+			return;
+		for (size_t i = pos + 1; i < str.size(); i++)
+			if (!isdigit((unsigned char)str[i]))
+				return;
+		max_idx = std::max(max_idx, atoi(str.c_str() + pos + 1) + 1);
+	};
+	for (auto &it : module->wires_)
+		scan(it.first);
+	for (auto &it : module->memories)
+		scan(it.first);
+	for (auto &it : module->cells_)
+		scan(it.first);
+	for (auto &it : module->processes)
+		scan(it.first);
+	return max_idx;
+}
+
+bool write_file_if_changed(const std::string &filename, const std::string &content)
+{
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin) {
+		std::string old_content((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+		if (old_content == content)
+			return false;
+	}
+	fin.close();
+
+	std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+	if (fout.fail())
+		log_error("Can't open file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+	fout.write(content.data(), content.size());
+	if (fout.fail())
+		log_error("Can't write to file `%s': %s\n", filename.c_str(), strerror(errno));
+	return true;
+}
+
 struct RTLILBackend : public Backend {
 	RTLILBackend() : Backend("rtlil", "write design to RTLIL file") { }
 	void help() override
@@ -431,10 +503,19 @@ struct RTLILBackend : public Backend {
 		log("    -selected\n");
 		log("        only write selected parts of the design.\n");
 		log("\n");
+		log("    -split <dirname>\n");
+		log("        write each module to its own file <dirname>/<module>.il instead of\n");
+		log("        writing a single file. files whose contents did not change are not\n");
+		log("        rewritten, and the directory is created if it does not exist. the\n");
+		log("        design can be read back with 'read_rtlil <dirname>/*.il'. files of\n");
+		log("        modules that are no longer in the design are not removed. with\n");
+		log("        -selected, only the selected modules are written.\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool selected = false;
+		std::string split_dir;
 
 		log_header(design, "Executing RTLIL backend.\n");
 
@@ -445,8 +526,21 @@ struct RTLILBackend : public Backend {
 				selected = true;
 				continue;
 			}
+			if (arg == "-split" && argidx+1 < args.size()) {
+				split_dir = args[++argidx];
+				continue;
+			}
 			break;
 		}
+
+		if (!split_dir.empty()) {
+			if (argidx != args.size())
+				cmd_error(args, argidx, "Extra argument with -split.");
+			design->sort();
+			write_split(split_dir, design, selected);
+			return;
+		}
+
 		extra_args(f, filename, args, argidx);
 
 		design->sort();
@@ -455,6 +549,35 @@ struct RTLILBackend : public Backend {
 		*f << stringf("# Generated by %s\n", yosys_version_str);
 		RTLIL_BACKEND::dump_design(*f, design, selected, true, false);
 	}
+	void write_split(std::string dirname, RTLIL::Design *design, bool selected)
+	{
+		rewrite_filename(dirname);
+		log("Output directory: %s\n", dirname.c_str());
+#ifdef _WIN32
+		_mkdir(dirname.c_str());
+#else
+		mkdir(dirname.c_str(), 0777);
+#endif
+
+		int count_written = 0, count_unchanged = 0;
+		for (auto module : design->modules()) {
+			if (selected && !design->selected(module))
+				continue;
+			// Every file carries an autoidx above the ids used in its own module, so that
+			// any subset of files can be read back on its own.
+			std::ostringstream buf;
+			buf << stringf("# Generated by %s\n", yosys_version_str);
+			int module_autoidx = split_module_autoidx(module);
+			if (module_autoidx > 0)
+				buf << stringf("autoidx %d\n", module_autoidx);
+			RTLIL_BACKEND::dump_module(buf, "", module, design, false);
+			if (write_file_if_changed(dirname + "/" + split_module_filename(module->name), buf.str()))
+				count_written++;
+			else
+				count_unchanged++;
+		}
+		log("Wrote %d module files, %d unchanged.\n", count_written, count_unchanged);
+	}
 } RTLILBackend;
 
 struct IlangBackend : public Backend {
@@ -151,6 +151,7 @@ struct HierDirtyFlags
 struct SimplecWorker
 {
 	bool verbose = false;
+	bool bitslice = false;
 	int max_uintsize = 32;
 
 	Design *design;
@@ -182,6 +183,9 @@ struct SimplecWorker
 
 	string sigtype(int n)
 	{
+		if (bitslice)
+			return bitslice_sigtype(n);
+
 		string struct_name = stringf("signal%d_t", n);
 
 		if (generated_sigtypes.count(n) == 0)
@@ -211,6 +215,48 @@ struct SimplecWorker
 		return struct_name;
 	}
 
+	// In -bitslice mode each signal bit is a 64-bit word holding the values of
+	// 64 independent simulation vectors, so all cells are evaluated bitwise.
+	string bitslice_sigtype(int n)
+	{
+		string struct_name = stringf("bitslice%d_t", n);
+
+		if (generated_sigtypes.count(n) == 0)
+		{
+			signal_declarations.push_back("");
+			signal_declarations.push_back(stringf("#ifndef YOSYS_SIMPLEC_BITSLICE%d_T", n));
+			signal_declarations.push_back(stringf("#define YOSYS_SIMPLEC_BITSLICE%d_T", n));
+			signal_declarations.push_back(stringf("typedef struct {"));
+			signal_declarations.push_back(stringf("  uint64_t bits[%d];", std::max(n, 1)));
+			signal_declarations.push_back(stringf("} bitslice%d_t;", n));
+			signal_declarations.push_back(stringf("#endif"));
+			generated_sigtypes.insert(n);
+		}
+
+		return struct_name;
+	}
+
+	string const_expr(bool value)
+	{
+		if (bitslice)
+			return value ? "~(uint64_t)0" : "(uint64_t)0";
+		return value ? "1" : "0";
+	}
+
+	string init_expr(bool value)
+	{
+		if (bitslice)
+			return const_expr(value);
+		return value ? "true" : "false";
+	}
+
+	string bit_expr(HierDirtyFlags *work, SigBit bit)
+	{
+		if (bit.wire == nullptr)
+			return const_expr(bit.data != State::S0);
+		return util_get_bit(work->prefix + cid(bit.wire->name), bit.wire->width, bit.offset);
+	}
+
 	void util_ifdef_guard(string s)
 	{
 		for (int i = 0; i < GetSize(s); i++)
@@ -224,6 +270,9 @@ struct SimplecWorker
 
 	string util_get_bit(const string &signame, int n, int idx)
 	{
+		if (bitslice)
+			return stringf("%s.bits[%d]", signame.c_str(), idx);
+
 		if (n == 1 && idx == 0)
 			return signame + ".value_0_0";
 
@@ -250,6 +299,9 @@ struct SimplecWorker
 
 	string util_set_bit(const string &signame, int n, int idx, const string &expr)
 	{
+		if (bitslice)
+			return stringf("  %s.bits[%d] = %s;", signame.c_str(), idx, expr.c_str());
+
 		if (n == 1 && idx == 0)
 			return stringf("  %s.value_0_0 = %s;", signame.c_str(), expr.c_str());
 
@@ -378,16 +430,18 @@ struct SimplecWorker
 
 	void eval_cell(HierDirtyFlags *work, Cell *cell)
 	{
+		const char *op_not = bitslice ? "~" : "!";
+
 		if (cell->type.in(ID($_BUF_), ID($_NOT_)))
 		{
 			SigBit a = sigmaps.at(work->module)(cell->getPort(ID::A));
 			SigBit y = sigmaps.at(work->module)(cell->getPort(ID::Y));
 
-			string a_expr = a.wire ? util_get_bit(work->prefix + cid(a.wire->name), a.wire->width, a.offset) : a.data ? "1" : "0";
+			string a_expr = bit_expr(work, a);
 			string expr;
 
 			if (cell->type == ID($_BUF_))  expr = a_expr;
-			if (cell->type == ID($_NOT_))  expr = "!" + a_expr;
+			if (cell->type == ID($_NOT_))  expr = op_not + a_expr;
 
 			log_assert(y.wire);
 			funct_declarations.push_back(util_set_bit(work->prefix + cid(y.wire->name), y.wire->width, y.offset, expr) +
@@ -403,18 +457,18 @@ struct SimplecWorker
 			SigBit b = sigmaps.at(work->module)(cell->getPort(ID::B));
 			SigBit y = sigmaps.at(work->module)(cell->getPort(ID::Y));
 
-			string a_expr = a.wire ? util_get_bit(work->prefix + cid(a.wire->name), a.wire->width, a.offset) : a.data ? "1" : "0";
-			string b_expr = b.wire ? util_get_bit(work->prefix + cid(b.wire->name), b.wire->width, b.offset) : b.data ? "1" : "0";
+			string a_expr = bit_expr(work, a);
+			string b_expr = bit_expr(work, b);
 			string expr;
 
 			if (cell->type == ID($_AND_))    expr = stringf("%s & %s",    a_expr.c_str(), b_expr.c_str());
-			if (cell->type == ID($_NAND_))   expr = stringf("!(%s & %s)", a_expr.c_str(), b_expr.c_str());
+			if (cell->type == ID($_NAND_))   expr = stringf("%s(%s & %s)", op_not, a_expr.c_str(), b_expr.c_str());
 			if (cell->type == ID($_OR_))     expr = stringf("%s | %s",    a_expr.c_str(), b_expr.c_str());
-			if (cell->type == ID($_NOR_))    expr = stringf("!(%s | %s)", a_expr.c_str(), b_expr.c_str());
+			if (cell->type == ID($_NOR_))    expr = stringf("%s(%s | %s)", op_not, a_expr.c_str(), b_expr.c_str());
 			if (cell->type == ID($_XOR_))    expr = stringf("%s ^ %s",    a_expr.c_str(), b_expr.c_str());
-			if (cell->type == ID($_XNOR_))   expr = stringf("!(%s ^ %s)", a_expr.c_str(), b_expr.c_str());
-			if (cell->type == ID($_ANDNOT_)) expr = stringf("%s & (!%s)", a_expr.c_str(), b_expr.c_str());
-			if (cell->type == ID($_ORNOT_))  expr = stringf("%s | (!%s)", a_expr.c_str(), b_expr.c_str());
+			if (cell->type == ID($_XNOR_))   expr = stringf("%s(%s ^ %s)", op_not, a_expr.c_str(), b_expr.c_str());
+			if (cell->type == ID($_ANDNOT_)) expr = stringf("%s & (%s%s)", a_expr.c_str(), op_not, b_expr.c_str());
+			if (cell->type == ID($_ORNOT_))  expr = stringf("%s | (%s%s)", a_expr.c_str(), op_not, b_expr.c_str());
 
 			log_assert(y.wire);
 			funct_declarations.push_back(util_set_bit(work->prefix + cid(y.wire->name), y.wire->width, y.offset, expr) +
@@ -431,13 +485,13 @@ struct SimplecWorker
 			SigBit c = sigmaps.at(work->module)(cell->getPort(ID::C));
 			SigBit y = sigmaps.at(work->module)(cell->getPort(ID::Y));
 
-			string a_expr = a.wire ? util_get_bit(work->prefix + cid(a.wire->name), a.wire->width, a.offset) : a.data ? "1" : "0";
-			string b_expr = b.wire ? util_get_bit(work->prefix + cid(b.wire->name), b.wire->width, b.offset) : b.data ? "1" : "0";
-			string c_expr = c.wire ? util_get_bit(work->prefix + cid(c.wire->name), c.wire->width, c.offset) : c.data ? "1" : "0";
+			string a_expr = bit_expr(work, a);
+			string b_expr = bit_expr(work, b);
+			string c_expr = bit_expr(work, c);
 			string expr;
 
-			if (cell->type == ID($_AOI3_)) expr = stringf("!((%s & %s) | %s)", a_expr.c_str(), b_expr.c_str(), c_expr.c_str());
-			if (cell->type == ID($_OAI3_)) expr = stringf("!((%s | %s) & %s)", a_expr.c_str(), b_expr.c_str(), c_expr.c_str());
+			if (cell->type == ID($_AOI3_)) expr = stringf("%s((%s & %s) | %s)", op_not, a_expr.c_str(), b_expr.c_str(), c_expr.c_str());
+			if (cell->type == ID($_OAI3_)) expr = stringf("%s((%s | %s) & %s)", op_not, a_expr.c_str(), b_expr.c_str(), c_expr.c_str());
 
 			log_assert(y.wire);
 			funct_declarations.push_back(util_set_bit(work->prefix + cid(y.wire->name), y.wire->width, y.offset, expr) +
@@ -455,14 +509,14 @@ struct SimplecWorker
 			SigBit d = sigmaps.at(work->module)(cell->getPort(ID::D));
 			SigBit y = sigmaps.at(work->module)(cell->getPort(ID::Y));
 
-			string a_expr = a.wire ? util_get_bit(work->prefix + cid(a.wire->name), a.wire->width, a.offset) : a.data ? "1" : "0";
-			string b_expr = b.wire ? util_get_bit(work->prefix + cid(b.wire->name), b.wire->width, b.offset) : b.data ? "1" : "0";
-			string c_expr = c.wire ? util_get_bit(work->prefix + cid(c.wire->name), c.wire->width, c.offset) : c.data ? "1" : "0";
-			string d_expr = d.wire ? util_get_bit(work->prefix + cid(d.wire->name), d.wire->width, d.offset) : d.data ? "1" : "0";
+			string a_expr = bit_expr(work, a);
+			string b_expr = bit_expr(work, b);
+			string c_expr = bit_expr(work, c);
+			string d_expr = bit_expr(work, d);
 			string expr;
 
-			if (cell->type == ID($_AOI4_)) expr = stringf("!((%s & %s) | (%s & %s))", a_expr.c_str(), b_expr.c_str(), c_expr.c_str(), d_expr.c_str());
-			if (cell->type == ID($_OAI4_)) expr = stringf("!((%s | %s) & (%s | %s))", a_expr.c_str(), b_expr.c_str(), c_expr.c_str(), d_expr.c_str());
+			if (cell->type == ID($_AOI4_)) expr = stringf("%s((%s & %s) | (%s & %s))", op_not, a_expr.c_str(), b_expr.c_str(), c_expr.c_str(), d_expr.c_str());
+			if (cell->type == ID($_OAI4_)) expr = stringf("%s((%s | %s) & (%s | %s))", op_not, a_expr.c_str(), b_expr.c_str(), c_expr.c_str(), d_expr.c_str());
 
 			log_assert(y.wire);
 			funct_declarations.push_back(util_set_bit(work->prefix + cid(y.wire->name), y.wire->width, y.offset, expr) +
@@ -479,14 +533,17 @@ struct SimplecWorker
 			SigBit s = sigmaps.at(work->module)(cell->getPort(ID::S));
 			SigBit y = sigmaps.at(work->module)(cell->getPort(ID::Y));
 
-			string a_expr = a.wire ? util_get_bit(work->prefix + cid(a.wire->name), a.wire->width, a.offset) : a.data ? "1" : "0";
-			string b_expr = b.wire ? util_get_bit(work->prefix + cid(b.wire->name), b.wire->width, b.offset) : b.data ? "1" : "0";
-			string s_expr = s.wire ? util_get_bit(work->prefix + cid(s.wire->name), s.wire->width, s.offset) : s.data ? "1" : "0";
+			string a_expr = bit_expr(work, a);
+			string b_expr = bit_expr(work, b);
+			string s_expr = bit_expr(work, s);
 
 			// casts to bool are a workaround for CBMC bug (https://github.com/diffblue/cbmc/issues/933)
 			string expr = stringf("%s ? %s(bool)%s : %s(bool)%s", s_expr.c_str(),
 					cell->type == ID($_NMUX_) ? "!" : "", b_expr.c_str(),
 					cell->type == ID($_NMUX_) ? "!" : "", a_expr.c_str());
+			if (bitslice)
+				expr = stringf("%s((%s & %s) | (~%s & %s))", cell->type == ID($_NMUX_) ? "~" : "",
+						s_expr.c_str(), b_expr.c_str(), s_expr.c_str(), a_expr.c_str());
 
 			log_assert(y.wire);
 			funct_declarations.push_back(util_set_bit(work->prefix + cid(y.wire->name), y.wire->width, y.offset, expr) +
@@ -662,7 +719,7 @@ struct SimplecWorker
 				for (int i = 0; i < GetSize(sig); i++)
 					if (val[i] == State::S0 || val[i] == State::S1) {
 						SigBit bit = sig[i];
-						preamble.push_back(util_set_bit(work->prefix + cid(bit.wire->name), bit.wire->width, bit.offset, val == State::S1 ? "true" : "false"));
+						preamble.push_back(util_set_bit(work->prefix + cid(bit.wire->name), bit.wire->width, bit.offset, init_expr(val == State::S1)));
 						work->set_dirty(bit);
 					}
 			}
@@ -672,7 +729,7 @@ struct SimplecWorker
 				SigBit val = sigmaps.at(module)(bit);
 
 				if (val == State::S0 || val == State::S1)
-					preamble.push_back(util_set_bit(work->prefix + cid(bit.wire->name), bit.wire->width, bit.offset, val == State::S1 ? "true" : "false"));
+					preamble.push_back(util_set_bit(work->prefix + cid(bit.wire->name), bit.wire->width, bit.offset, init_expr(val == State::S1)));
 
 				if (driven_bits.at(module).count(val) == 0)
 					work->set_dirty(val);
@@ -760,6 +817,12 @@ struct SimplecBackend : public Backend {
 		log("    -i8, -i16, -i32, -i64\n");
 		log("        set the maximum integer bit width to use in the generated code.\n");
 		log("\n");
+		log("    -bitslice\n");
+		log("        generate bit-sliced code: every signal bit is stored as a uint64_t word\n");
+		log("        and all cells are evaluated with bitwise operations, so each call\n");
+		log("        of the generated functions simulates 64 independent input vectors.\n");
+		log("        (the -i* options have no effect in this mode.)\n");
+		log("\n");
 		log("THIS COMMAND IS UNDER CONSTRUCTION\n");
 		log("\n");
 	}
@@ -795,6 +858,10 @@ struct SimplecBackend : public Backend {
 				worker.max_uintsize = 64;
 				continue;
 			}
+			if (args[argidx] == "-bitslice") {
+				worker.bitslice = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
@@ -0,0 +1,5 @@
+#!/bin/bash
+set -ex
+../../yosys -p 'synth -top test; write_simplec -bitslice test01_uut.c' test00_uut.v
+clang -o test01_tb test01_tb.c
+./test01_tb
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <assert.h>
+#include "test01_uut.c"
+
+uint64_t xorshift64()
+{
+	static uint64_t x64 = 88172645463325252ull;
+	x64 ^= x64 << 13;
+	x64 ^= x64 >> 7;
+	x64 ^= x64 << 17;
+	return x64;
+}
+
+int main()
+{
+	struct test_state_t state;
+	bool first_eval = true;
+
+	for (int i = 0; i < 10; i++)
+	{
+		// each bit position holds 64 independent test vectors
+		for (int k = 0; k < 32; k++) {
+			state.a.bits[k] = xorshift64();
+			state.b.bits[k] = xorshift64();
+			state.c.bits[k] = xorshift64();
+		}
+
+		if (first_eval) {
+			first_eval = false;
+			test_init(&state);
+		} else {
+			test_eval(&state);
+		}
+
+		for (int k = 0; k < 32; k++) {
+			uint64_t a = state.a.bits[k], b = state.b.bits[k], c = state.c.bits[k];
+			assert(state.x.bits[k] == ((a & b) | c));
+			assert(state.y.bits[k] == (a & (b | c)));
+			assert(state.z.bits[k] == (a ^ b ^ c));
+			assert(state.w.bits[k] == (a ^ b ^ c));
+		}
+		printf("%d: 0x%016llx\n", i, (unsigned long long)state.x.bits[0]);
+	}
+
+	return 0;
+}
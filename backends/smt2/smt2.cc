@@ -24,8 +24,13 @@
 #include "kernel/log.h"
 #include "kernel/mem.h"
 #include "libs/json11/json11.hpp"
+#include "libs/sha1/sha1.h"
 #include <string>
 
+#ifndef _WIN32
+#  include <sys/stat.h>
+#endif
+
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
@@ -1693,6 +1698,16 @@ struct Smt2Backend : public Backend {
 		log("        emit a `; yosys-smt2-solver-option` directive for yosys-smtbmc to write\n");
 		log("        the given option as a `(set-option ...)` command in the SMT-LIBv2.\n");
 		log("\n");
+		log("    -split <dirname>\n");
+		log("        write the definitions of each module to a separate file named after the\n");
+		log("        SHA1 hash of its contents in <dirname>, and only reference these files\n");
+		log("        from the main output file using `; yosys-smt2-include <file>`\n");
+		log("        directives. files that already exist are not rewritten, so unchanged\n");
+		log("        modules can be cached between runs. a relative <dirname> is relative\n");
+		log("        to the directory of the main output file, which is also how\n");
+		log("        yosys-smtbmc resolves the includes. (the main output file is not\n");
+		log("        self-contained SMT-LIBv2 with this option.)\n");
+		log("\n");
 		log("[1] For more information on SMT-LIBv2 visit http://smt-lib.org/ or read David\n");
 		log("R. Cok's tutorial: https://smtlib.github.io/jSMTLIB/SMTLIBTutorial.pdf\n");
 		log("\n");
@@ -1748,6 +1763,8 @@ struct Smt2Backend : public Backend {
 		bool bvmode = true, memmode = true, wiresmode = false, verbose = false, statebv = false, statedt = false;
 		bool forallmode = false;
 		dict<std::string, std::string> solver_options;
+		std::string split_dir;
+		int split_written = 0, split_cached = 0;
 
 		log_header(design, "Executing SMT2 backend.\n");
 
@@ -1801,10 +1818,28 @@ struct Smt2Backend : public Backend {
 				argidx += 2;
 				continue;
 			}
+			if (args[argidx] == "-split" && argidx+1 < args.size()) {
+				split_dir = args[++argidx];
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
+		// module files are written relative to the main output file, which is where they are included from
+		std::string split_path = split_dir;
+		if (!split_dir.empty()) {
+			size_t dir_end = filename.find_last_of("/\\");
+			bool is_absolute = split_dir[0] == '/' || split_dir[0] == '\\' || split_dir.find(':') != std::string::npos;
+			if (!is_absolute && f != &std::cout && dir_end != std::string::npos)
+				split_path = filename.substr(0, dir_end + 1) + split_dir;
+#ifdef _WIN32
+			_mkdir(split_path.c_str());
+#else
+			mkdir(split_path.c_str(), 0777);
+#endif
+		}
+
 		if (template_f.is_open()) {
 			std::string line;
 			while (std::getline(template_f, line)) {
@@ -1892,12 +1927,48 @@ struct Smt2Backend : public Backend {
 
 			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, mod_stbv_width, mod_clk_cache);
 			worker.run();
-			worker.write(*f);
+
+			if (split_dir.empty()) {
+				worker.write(*f);
+			} else {
+				std::ostringstream buf;
+				worker.write(buf);
+				std::string content = buf.str();
+				std::string module_filename = sha1(content) + ".smt2";
+				std::string module_path = split_path + "/" + module_filename;
+				if (check_file_exists(module_path)) {
+					split_cached++;
+				} else {
+					// The file name promises the contents, so an interrupted run must not
+					// leave a truncated file under that name: write to a temporary file
+					// in the same directory and rename it into place.
+					std::string temp_path = make_temp_file(module_path + ".XXXXXX");
+					std::ofstream module_f(temp_path.c_str(), std::ofstream::trunc);
+					if (module_f.fail())
+						log_error("Can't open file `%s' for writing: %s\n", temp_path.c_str(), strerror(errno));
+					module_f << content;
+					module_f.close();
+					if (module_f.fail()) {
+						remove(temp_path.c_str());
+						log_error("Can't write to file `%s': %s\n", temp_path.c_str(), strerror(errno));
+					}
+					if (rename(temp_path.c_str(), module_path.c_str()) != 0) {
+						remove(temp_path.c_str());
+						if (!check_file_exists(module_path))
+							log_error("Can't rename `%s' to `%s': %s\n", temp_path.c_str(), module_path.c_str(), strerror(errno));
+					}
+					split_written++;
+				}
+				*f << stringf("; yosys-smt2-include %s/%s\n", split_dir.c_str(), module_filename.c_str());
+			}
 
 			if (module == topmod)
 				topmod_id = worker.get_id(module);
 		}
 
+		if (!split_dir.empty())
+			log("Wrote %d module files to `%s', %d were unchanged.\n", split_written, split_path.c_str(), split_cached);
+
 		if (topmod)
 			*f << stringf("; yosys-smt2-topmod %s\n", topmod_id.c_str());
 
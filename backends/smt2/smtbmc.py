@@ -447,9 +447,16 @@ def print_msg(msg):
 
 print_msg("Solver: %s" % (so.solver))
 
-with open(args[0], "r") as f:
-    for line in f:
-        smt.write(line)
+def write_smt2_file(filename):
+    with open(filename, "r") as f:
+        for line in f:
+            if line.startswith("; yosys-smt2-include "):
+                include = line[len("; yosys-smt2-include "):].strip()
+                write_smt2_file(os.path.join(os.path.dirname(filename), include))
+                continue
+            smt.write(line)
+
+write_smt2_file(args[0])
 
 for line in constr_write:
     smt.write(line)
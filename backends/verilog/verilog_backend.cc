@@ -38,7 +38,8 @@ PRIVATE_NAMESPACE_BEGIN
 bool verbose, norename, noattr, attr2comment, noexpr, nodec, nohex, nostr, extmem, defparam, decimal, siminit, systemverilog, simple_lhs, noparallelcase;
 int auto_name_counter, auto_name_offset, auto_name_digits, extmem_counter;
 std::map<RTLIL::IdString, int> auto_name_map;
-std::set<RTLIL::IdString> reg_wires;
+pool<RTLIL::IdString> reg_wires;
+dict<RTLIL::IdString, std::string> id_cache;
 std::string auto_prefix, extmem_prefix;
 
 RTLIL::Module *active_module;
@@ -71,6 +72,7 @@ void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 void reset_auto_counter(RTLIL::Module *module)
 {
 	auto_name_map.clear();
+	id_cache.clear();
 	auto_name_counter = 0;
 	auto_name_offset = 0;
 
@@ -101,13 +103,16 @@ std::string next_auto_id()
 	return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_counter++);
 }
 
-std::string id(RTLIL::IdString internal_id, bool may_rename = true)
+std::string escape_id(RTLIL::IdString internal_id, bool may_rename)
 {
 	const char *str = internal_id.c_str();
 	bool do_escape = false;
 
-	if (may_rename && auto_name_map.count(internal_id) != 0)
-		return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_map[internal_id]);
+	if (may_rename) {
+		auto it = auto_name_map.find(internal_id);
+		if (it != auto_name_map.end())
+			return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + it->second);
+	}
 
 	if (*str == '\\')
 		str++;
@@ -129,7 +134,7 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 		break;
 	}
 
-	const pool<string> keywords = {
+	static const pool<string> keywords = {
 		// IEEE 1800-2017 Annex B
 		"accept_on", "alias", "always", "always_comb", "always_ff", "always_latch", "and", "assert", "assign", "assume", "automatic", "before",
 		"begin", "bind", "bins", "binsof", "bit", "break", "buf", "bufif0", "bufif1", "byte", "case", "casex", "casez", "cell", "chandle",
@@ -161,6 +166,18 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 	return std::string(str);
 }
 
+// Escaped names only depend on the module being dumped (see reset_auto_counter()), and wire names
+// in particular are referenced many times, so they are cached until the next module is started.
+std::string id(RTLIL::IdString internal_id, bool may_rename = true)
+{
+	if (!may_rename)
+		return escape_id(internal_id, false);
+	auto it = id_cache.find(internal_id);
+	if (it != id_cache.end())
+		return it->second;
+	return id_cache[internal_id] = escape_id(internal_id, true);
+}
+
 bool is_reg_wire(RTLIL::SigSpec sig, std::string &reg_name)
 {
 	if (!sig.is_chunk() || sig.as_chunk().wire == NULL)
@@ -276,11 +293,11 @@ void dump_const(std::ostream &f, const RTLIL::Const &data, int width = -1, int o
 			for (int i = offset+width-1; i >= offset; i--) {
 				log_assert(i < (int)data.bits.size());
 				switch (data.bits[i]) {
-				case State::S0: f << stringf("0"); break;
-				case State::S1: f << stringf("1"); break;
-				case RTLIL::Sx: f << stringf("x"); break;
-				case RTLIL::Sz: f << stringf("z"); break;
-				case RTLIL::Sa: f << stringf("?"); break;
+				case State::S0: f << '0'; break;
+				case State::S1: f << '1'; break;
+				case RTLIL::Sx: f << 'x'; break;
+				case RTLIL::Sz: f << 'z'; break;
+				case RTLIL::Sa: f << '?'; break;
 				case RTLIL::Sm: log_error("Found marker state in final netlist.");
 				}
 			}
@@ -336,12 +353,12 @@ void dump_sigchunk(std::ostream &f, const RTLIL::SigChunk &chunk, bool no_decima
 		dump_const(f, chunk.data, chunk.width, chunk.offset, no_decimal);
 	} else {
 		if (chunk.width == chunk.wire->width && chunk.offset == 0) {
-			f << stringf("%s", id(chunk.wire->name).c_str());
+			f << id(chunk.wire->name);
 		} else if (chunk.width == 1) {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << id(chunk.wire->name) << '[' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), chunk.offset + chunk.wire->start_offset);
+				f << id(chunk.wire->name) << '[' << chunk.offset + chunk.wire->start_offset << ']';
 		} else {
 			if (chunk.wire->upto)
 				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
@@ -368,7 +385,7 @@ void dump_sigspec(std::ostream &f, const RTLIL::SigSpec &sig)
 		f << stringf("{ ");
 		for (auto it = sig.chunks().rbegin(); it != sig.chunks().rend(); ++it) {
 			if (it != sig.chunks().rbegin())
-				f << stringf(", ");
+				f << ", ";
 			dump_sigchunk(f, *it, true);
 		}
 		f << stringf(" }");
@@ -2049,7 +2066,7 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 
 	if (!noexpr)
 	{
-		std::set<std::pair<RTLIL::Wire*,int>> reg_bits;
+		pool<std::pair<RTLIL::Wire*,int>> reg_bits;
 		for (auto cell : module->cells())
 		{
 			if (!RTLIL::builtin_ff_cell_types().count(cell->type) || !cell->hasPort(ID::Q) || cell->type.in(ID($ff), ID($_FF_)))
@@ -2077,19 +2094,21 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 
 	dump_attributes(f, indent, module->attributes, '\n', /*modattr=*/true);
 	f << stringf("%s" "module %s(", indent.c_str(), id(module->name, false).c_str());
-	bool keep_running = true;
+	std::vector<std::vector<RTLIL::Wire*>> port_wires;
+	for (auto wire : module->wires()) {
+		if (wire->port_id <= 0)
+			continue;
+		if (wire->port_id >= GetSize(port_wires))
+			port_wires.resize(wire->port_id + 1);
+		port_wires[wire->port_id].push_back(wire);
+	}
 	int cnt = 0;
-	for (int port_id = 1; keep_running; port_id++) {
-		keep_running = false;
-		for (auto wire : module->wires()) {
-			if (wire->port_id == port_id) {
-				if (port_id != 1)
-					f << stringf(", ");
-				f << stringf("%s", id(wire->name).c_str());
-				keep_running = true;
-				if (cnt==20) { f << stringf("\n"); cnt = 0; } else cnt++;
-				continue;
-			}
+	for (int port_id = 1; port_id < GetSize(port_wires) && !port_wires[port_id].empty(); port_id++) {
+		for (auto wire : port_wires[port_id]) {
+			if (port_id != 1)
+				f << stringf(", ");
+			f << stringf("%s", id(wire->name).c_str());
+			if (cnt==20) { f << stringf("\n"); cnt = 0; } else cnt++;
 		}
 	}
 	f << stringf(");\n");
@@ -2350,6 +2369,7 @@ struct VerilogBackend : public Backend {
 
 		auto_name_map.clear();
 		reg_wires.clear();
+		id_cache.clear();
 	}
 } VerilogBackend;
 
@@ -338,14 +338,22 @@ static uint32_t parse_xaiger_literal(std::istream &f)
 
 RTLIL::Wire* AigerReader::createWireIfNotExists(RTLIL::Module *module, unsigned literal)
 {
+	// Literals are looked up by index first, so that the name of a wire only
+	// needs to be built once, when the wire is created.
+	if (literal < literal_wires.size() && literal_wires[literal] != nullptr)
+		return literal_wires[literal];
+	if (literal >= literal_wires.size())
+		literal_wires.resize(std::max<size_t>(literal + 2, 2 * literal_wires.size()), nullptr);
+
 	const unsigned variable = literal >> 1;
 	const bool invert = literal & 1;
 	RTLIL::IdString wire_name(stringf("$aiger%d$%d%s", aiger_autoidx, variable, invert ? "b" : ""));
 	RTLIL::Wire *wire = module->wire(wire_name);
-	if (wire) return wire;
+	if (wire) return literal_wires[literal] = wire;
 	log_debug2("Creating %s\n", wire_name.c_str());
 	wire = module->addWire(wire_name);
 	wire->port_input = wire->port_output = false;
+	literal_wires[literal] = wire;
 	if (!invert) return wire;
 	RTLIL::IdString wire_inv_name(stringf("$aiger%d$%d", aiger_autoidx, variable));
 	RTLIL::Wire *wire_inv = module->wire(wire_inv_name);
@@ -356,6 +364,7 @@ RTLIL::Wire* AigerReader::createWireIfNotExists(RTLIL::Module *module, unsigned
 		log_debug2("Creating %s\n", wire_inv_name.c_str());
 		wire_inv = module->addWire(wire_inv_name);
 		wire_inv->port_input = wire_inv->port_output = false;
+		literal_wires[literal ^ 1] = wire_inv;
 	}
 
 	log_debug2("Creating %s = ~%s\n", wire_name.c_str(), wire_inv_name.c_str());
@@ -639,12 +648,18 @@ void AigerReader::parse_aiger_ascii()
 	std::getline(f, line); // Ignore up to start of next line
 }
 
-static unsigned parse_next_delta_literal(std::istream &f, unsigned ref)
+static unsigned parse_next_delta_literal(std::streambuf *buf, unsigned ref)
 {
 	unsigned x = 0, i = 0;
-	unsigned char ch;
-	while ((ch = f.get()) & 0x80)
+	int ch;
+	while (1) {
+		ch = buf->sbumpc();
+		if (ch == std::char_traits<char>::eof())
+			log_error("Unexpected end of file in AND gate section!\n");
+		if (!(ch & 0x80))
+			break;
 		x |= (ch & 0x7f) << (7 * i++);
+	}
 	return ref - (x | (ch << (7 * i)));
 }
 
@@ -750,10 +765,16 @@ void AigerReader::parse_aiger_binary()
 		std::getline(f, line); // Ignore up to start of next line
 
 	// Parse AND
+	// Each AND gate creates a cell and up to three wires (the output and
+	// inverted inputs), so size the module's tables upfront.
+	module->wires_.reserve(module->wires_.size() + 2*A);
+	module->cells_.reserve(module->cells_.size() + 2*A);
+	literal_wires.resize(std::max<size_t>(literal_wires.size(), 2*(M+1)), nullptr);
+	std::streambuf *buf = f.rdbuf();
 	l1 = (I+L+1) << 1;
 	for (unsigned i = 0; i < A; ++i, ++line_count, l1 += 2) {
-		l2 = parse_next_delta_literal(f, l1);
-		l3 = parse_next_delta_literal(f, l2);
+		l2 = parse_next_delta_literal(buf, l1);
+		l3 = parse_next_delta_literal(buf, l2);
 
 		log_debug2("%d %d %d is an AND\n", l1, l2, l3);
 		log_assert(!(l1 & 1));
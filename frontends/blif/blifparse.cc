@@ -23,9 +23,58 @@ YOSYS_NAMESPACE_BEGIN
 
 const int lut_input_plane_limit = 12;
 
-static bool read_next_line(char *&buffer, size_t &buffer_size, int &line_count, std::istream &f)
+// Reads the input in large blocks and hands out physical lines without
+// going through std::getline and a temporary std::string for every line.
+struct BlifLineReader
+{
+	std::istream &f;
+	std::vector<char> block;
+	size_t block_pos, block_len;
+
+	BlifLineReader(std::istream &f) : f(f), block(1 << 16), block_pos(0), block_len(0) { }
+
+	// Append the next line (without line terminator) to buffer. Returns false
+	// if the end of the input has been reached before any character was read.
+	bool append_line(char *&buffer, size_t &buffer_size, int buffer_len)
+	{
+		bool got_chars = false;
+
+		while (1)
+		{
+			if (block_pos == block_len) {
+				f.read(block.data(), block.size());
+				block_len = f.gcount();
+				block_pos = 0;
+				if (block_len == 0) {
+					buffer[buffer_len] = 0;
+					return got_chars;
+				}
+			}
+
+			const char *start = block.data() + block_pos;
+			const char *eol = (const char*)memchr(start, '\n', block_len - block_pos);
+			size_t len = eol ? eol - start : block_len - block_pos;
+
+			while (buffer_size-buffer_len < len+1) {
+				buffer_size *= 2;
+				buffer = (char*)realloc(buffer, buffer_size);
+			}
+			memcpy(buffer+buffer_len, start, len);
+			buffer_len += len;
+			block_pos += len;
+			got_chars = true;
+
+			if (eol) {
+				block_pos++;
+				buffer[buffer_len] = 0;
+				return true;
+			}
+		}
+	}
+};
+
+static bool read_next_line(char *&buffer, size_t &buffer_size, int &line_count, BlifLineReader &reader)
 {
-	string strbuf;
 	int buffer_len = 0;
 	buffer[0] = 0;
 
@@ -45,13 +94,8 @@ static bool read_next_line(char *&buffer, size_t &buffer_size, int &line_count,
 			if (buffer_len > 0 && buffer[buffer_len-1] == '\\')
 				buffer[--buffer_len] = 0;
 			line_count++;
-			if (!std::getline(f, strbuf))
+			if (!reader.append_line(buffer, buffer_size, buffer_len))
 				return false;
-			while (buffer_size-buffer_len < strbuf.size()+1) {
-				buffer_size *= 2;
-				buffer = (char*)realloc(buffer, buffer_size);
-			}
-			strcpy(buffer+buffer_len, strbuf.c_str());
 		} else
 			return true;
 	}
@@ -132,10 +176,11 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 	size_t buffer_size = 4096;
 	char *buffer = (char*)malloc(buffer_size);
 	int line_count = 0;
+	BlifLineReader reader(f);
 
 	while (1)
 	{
-		if (!read_next_line(buffer, buffer_size, line_count, f)) {
+		if (!read_next_line(buffer, buffer_size, line_count, reader)) {
 			if (module != nullptr)
 				goto error;
 			free(buffer);
@@ -472,7 +517,7 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 				{
 					RTLIL::State state = RTLIL::State::Sa;
 					while (1) {
-						if (!read_next_line(buffer, buffer_size, line_count, f))
+						if (!read_next_line(buffer, buffer_size, line_count, reader))
 							goto error;
 						for (int i = 0; buffer[i]; i++) {
 							if (buffer[i] == ' ' || buffer[i] == '\t')
@@ -586,17 +631,28 @@ void parse_blif(RTLIL::Design *design, std::istream &f, IdString dff_name, bool
 			if (input_len > lut_input_plane_limit)
 				goto error;
 
-			for (int i = 0; i < (1 << input_len); i++) {
-				for (int j = 0; j < input_len; j++) {
-					char c1 = input[j];
-					if (c1 != '-') {
-						char c2 = (i & (1 << j)) != 0 ? '1' : '0';
-						if (c1 != c2)
-							goto try_next_value;
-					}
-				}
-				lutptr->bits.at(i) = !strcmp(output, "0") ? RTLIL::State::S0 : RTLIL::State::S1;
-			try_next_value:;
+			// Enumerate only the LUT entries covered by this cube: the bits
+			// in care_mask are fixed to care_value, all others are free.
+			int care_mask = 0, care_value = 0;
+			bool cube_valid = true;
+			for (int j = 0; j < input_len; j++) {
+				if (input[j] == '-')
+					continue;
+				if (input[j] != '0' && input[j] != '1')
+					cube_valid = false;
+				care_mask |= 1 << j;
+				if (input[j] == '1')
+					care_value |= 1 << j;
+			}
+
+			if (cube_valid) {
+				RTLIL::State state = !strcmp(output, "0") ? RTLIL::State::S0 : RTLIL::State::S1;
+				int free_mask = ((1 << input_len) - 1) & ~care_mask;
+				int i = 0;
+				do {
+					lutptr->bits.at(care_value | i) = state;
+					i = (i - free_mask) & free_mask;
+				} while (i != 0);
 			}
 
 			lut_default_state = !strcmp(output, "0") ? RTLIL::State::S1 : RTLIL::State::S0;
@@ -72,12 +72,64 @@ using json11::Json;
 
 struct RpcServer {
 	std::string name;
+	// Data received from the frontend that has not been consumed yet. Responses are buffered
+	// so that a raw source payload following a response line can be read without extra copies.
+	std::string buffer;
 
 	RpcServer(const std::string &name) : name(name) { }
 	virtual ~RpcServer() { }
 
 	virtual void write(const std::string &data) = 0;
-	virtual std::string read() = 0;
+	// Reads at most `length` bytes into `data`, returning the number of bytes read, or 0 at end of stream.
+	virtual size_t read_some(char *data, size_t length) = 0;
+
+	void fill_buffer() {
+		const size_t chunk_size = 65536;
+		size_t offset = buffer.length();
+		buffer.resize(offset + chunk_size);
+		size_t length = read_some(&buffer[offset], chunk_size);
+		buffer.resize(offset + length);
+		if (length == 0)
+			log_cmd_error("read failed: RPC frontend closed the connection\n");
+	}
+
+	std::string read_line() {
+		size_t scan_pos = 0, term_pos;
+		while ((term_pos = buffer.find('\n', scan_pos)) == std::string::npos) {
+			scan_pos = buffer.length();
+			fill_buffer();
+		}
+		std::string data = buffer.substr(0, term_pos + 1);
+		buffer.erase(0, term_pos + 1);
+		return data;
+	}
+
+	std::string read_bytes(size_t length) {
+		std::string data;
+		if (buffer.length() >= length) {
+			data = buffer.substr(0, length);
+			buffer.erase(0, length);
+			return data;
+		}
+		// Large payloads are read directly into their final location.
+		data.swap(buffer);
+		size_t offset = data.length();
+		data.resize(length);
+		while (offset < length) {
+			size_t result = read_some(&data[offset], length - offset);
+			if (result == 0)
+				log_cmd_error("read failed: RPC frontend closed the connection\n");
+			offset += result;
+		}
+		return data;
+	}
+
+	// Must be called once a response and any payload following it have been consumed,
+	// before the result of the call is used.
+	void end_response() {
+		if (!buffer.empty())
+			log_cmd_error("read failed: more than one response\n");
+	}
 
 	Json call(const Json &json_request) {
 		std::string request;
@@ -86,7 +138,7 @@ struct RpcServer {
 		log_debug("RPC frontend request: %s", request.c_str());
 		write(request);
 
-		std::string response = read();
+		std::string response = read_line();
 		log_debug("RPC frontend response: %s", response.c_str());
 		std::string error;
 		Json json_response = Json::parse(response, error);
@@ -112,10 +164,18 @@ struct RpcServer {
 		} else is_valid = false;
 		if (!is_valid)
 			log_cmd_error("RPC frontend returned malformed response: %s\n", response.dump().c_str());
+		end_response();
 		return modules;
 	}
 
-	std::pair<std::string, std::string> derive_module(const std::string &module, const dict<RTLIL::IdString, RTLIL::Const> &parameters) {
+	struct DerivedSource {
+		std::string frontend;
+		// Exactly one of these is set: the source text itself, or the path of a local file
+		// written by the frontend that contains it.
+		std::string source, path;
+	};
+
+	DerivedSource derive_module(const std::string &module, const dict<RTLIL::IdString, RTLIL::Const> &parameters) {
 		Json::object json_parameters;
 		for (auto &param : parameters) {
 			std::string type, value;
@@ -141,16 +201,24 @@ struct RpcServer {
 			{ "parameters", json_parameters },
 		});
 		bool is_valid = true;
-		std::string frontend, source;
+		DerivedSource derived;
 		if (response["frontend"].is_string())
-			frontend = response["frontend"].string_value();
-		else is_valid = false;
-		if (response["source"].is_string())
-			source = response["source"].string_value();
+			derived.frontend = response["frontend"].string_value();
 		else is_valid = false;
+		if (response["source"].is_string()) {
+			derived.source = response["source"].string_value();
+		} else if (response["source_length"].is_number()) {
+			double length = response["source_length"].number_value();
+			if (length >= 0 && length == (double)(size_t)length)
+				derived.source = read_bytes((size_t)length);
+			else is_valid = false;
+		} else if (response["source_path"].is_string()) {
+			derived.path = response["source_path"].string_value();
+		} else is_valid = false;
 		if (!is_valid)
 			log_cmd_error("RPC frontend returned malformed response: %s\n", response.dump().c_str());
-		return std::make_pair(frontend, source);
+		end_response();
+		return derived;
 	}
 };
 
@@ -182,12 +250,15 @@ struct RpcModule : RTLIL::Module {
 		if (design->has(derived_name)) {
 			log("Found cached RTLIL representation for module `%s'.\n", derived_name.c_str());
 		} else {
-			std::string command, input;
-			std::tie(command, input) = server->derive_module(stripped_name.substr(1), parameters);
+			RpcServer::DerivedSource derived = server->derive_module(stripped_name.substr(1), parameters);
 
-			std::istringstream input_stream(input);
 			RTLIL::Design *derived_design = new RTLIL::Design;
-			Frontend::frontend_call(derived_design, &input_stream, "<rpc>" + derived_name.substr(8), command);
+			if (derived.path.empty()) {
+				std::istringstream input_stream(derived.source);
+				Frontend::frontend_call(derived_design, &input_stream, "<rpc>" + derived_name.substr(8), derived.frontend);
+			} else {
+				Frontend::frontend_call(derived_design, nullptr, derived.path, derived.frontend);
+			}
 			derived_design->check();
 
 			dict<std::string, std::string> name_mangling;
@@ -261,21 +332,11 @@ struct HandleRpcServer : RpcServer {
 		} while(offset < (ssize_t)data.length());
 	}
 
-	std::string read() override {
-		std::string data;
-		ssize_t offset = 0;
-		while (data.length() == 0 || data[data.length() - 1] != '\n') {
-			data.resize(data.length() + 1024);
-			DWORD data_read;
-			if (!ReadFile(hrecv, &data[offset], data.length() - offset, &data_read, /*lpOverlapped=*/NULL))
-				log_cmd_error("ReadFile failed: %s\n", get_last_error_str().c_str());
-			offset += data_read;
-			data.resize(offset);
-			size_t term_pos = data.find('\n', offset);
-			if (term_pos != data.length() - 1 && term_pos != std::string::npos)
-				log_cmd_error("read failed: more than one response\n");
-		}
-		return data;
+	size_t read_some(char *data, size_t length) override {
+		DWORD data_read;
+		if (!ReadFile(hrecv, data, length, &data_read, /*lpOverlapped=*/NULL))
+			log_cmd_error("ReadFile failed: %s\n", get_last_error_str().c_str());
+		return data_read;
 	}
 
 	~HandleRpcServer() {
@@ -316,22 +377,12 @@ struct FdRpcServer : RpcServer {
 		} while(offset < (ssize_t)data.length());
 	}
 
-	std::string read() override {
-		std::string data;
-		ssize_t offset = 0;
-		while (data.length() == 0 || data[data.length() - 1] != '\n') {
-			data.resize(data.length() + 1024);
-			check_pid();
-			ssize_t result = ::read(fdrecv, &data[offset], data.length() - offset);
-			if (result == -1)
-				log_cmd_error("read failed: %s\n", strerror(errno));
-			offset += result;
-			data.resize(offset);
-			size_t term_pos = data.find('\n', offset);
-			if (term_pos != data.length() - 1 && term_pos != std::string::npos)
-				log_cmd_error("read failed: more than one response\n");
-		}
-		return data;
+	size_t read_some(char *data, size_t length) override {
+		check_pid();
+		ssize_t result = ::read(fdrecv, data, length);
+		if (result == -1)
+			log_cmd_error("read failed: %s\n", strerror(errno));
+		return result;
 	}
 
 	~FdRpcServer() {
@@ -389,6 +440,17 @@ struct RpcFrontend : public Pass {
 		log("        frontend to return anyconvenient representation of the module. the\n");
 		log("        derived module is cached,so the response should be the same whenever the\n");
 		log("        same set of parameters is provided.\n");
+		log("\n");
+		log("    <- {\"frontend\": \"[rtlil|verilog|...]\", \"source_length\": <length>}\n");
+		log("        instead of embedding <source> in the JSON response, the frontend may\n");
+		log("        send its <length> in bytes, immediately followed by the raw <source>\n");
+		log("        after the newline terminating the response. this avoids escaping and\n");
+		log("        unescaping large sources.\n");
+		log("\n");
+		log("    <- {\"frontend\": \"[rtlil|verilog|...]\", \"source_path\": \"<path>\"}\n");
+		log("        the frontend may also write <source> to a local file (e.g. in /dev/shm)\n");
+		log("        and send its <path>, which is read by the built-in Yosys <frontend>\n");
+		log("        directly. the frontend remains responsible for removing the file.\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
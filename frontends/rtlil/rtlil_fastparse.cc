@@ -0,0 +1,779 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  A hand-written recursive-descent reader for the RTLIL text representation.
+ *  It accepts the same language as rtlil_parser.y/rtlil_lexer.l, but reads
+ *  the whole input into one buffer and tokenizes it in place, so that
+ *  identifiers are interned directly from the buffer and no per-token
+ *  strings are allocated.
+ *
+ */
+
+#include "frontends/rtlil/rtlil_frontend.h"
+#include <climits>
+#include <cerrno>
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+struct RTLILFastParser
+{
+	enum TokenType {
+		T_EOF, T_EOL, T_ID, T_VALUE, T_INT, T_STRING, T_CHAR, T_INVALID,
+		T_AUTOIDX, T_MODULE, T_ATTRIBUTE, T_PARAMETER, T_SIGNED, T_REAL, T_WIRE,
+		T_MEMORY, T_WIDTH, T_UPTO, T_OFFSET, T_SIZE, T_INPUT, T_OUTPUT, T_INOUT,
+		T_CELL, T_CONNECT, T_SWITCH, T_CASE, T_ASSIGN, T_SYNC, T_LOW, T_HIGH,
+		T_POSEDGE, T_NEGEDGE, T_EDGE, T_ALWAYS, T_GLOBAL, T_INIT, T_UPDATE,
+		T_MEMWR, T_PROCESS, T_END
+	};
+
+	struct Token {
+		TokenType type;
+		char *str;
+		int len;
+		int integer;
+	};
+
+	std::vector<char> buffer;
+	char *ptr, *end;
+	int line_count;
+
+	Token tok;
+	bool have_tok;
+
+	RTLIL::Design *design;
+	RTLIL::Module *module;
+	dict<RTLIL::IdString, RTLIL::Const> attrbuf;
+	bool flag_nooverwrite, flag_overwrite, flag_lib;
+
+	RTLILFastParser(std::istream &f, RTLIL::Design *design, bool flag_nooverwrite, bool flag_overwrite, bool flag_lib) :
+			line_count(1), have_tok(false), design(design), module(nullptr),
+			flag_nooverwrite(flag_nooverwrite), flag_overwrite(flag_overwrite), flag_lib(flag_lib)
+	{
+		// Read the whole input in large blocks. The extra byte at the end is a
+		// terminator that lets us null-terminate the last token in place.
+		const size_t block_size = 1 << 20;
+		size_t size = 0;
+		while (f) {
+			buffer.resize(size + block_size);
+			f.read(buffer.data() + size, block_size);
+			size += f.gcount();
+		}
+		buffer.resize(size + 1);
+		buffer[size] = 0;
+		ptr = buffer.data();
+		end = ptr + size;
+	}
+
+	[[noreturn]] void error(const std::string &msg)
+	{
+		log_error("Parser error in line %d: %s\n", line_count, msg.c_str());
+	}
+
+	static TokenType keyword(const char *p, int len)
+	{
+		static const struct { const char *name; TokenType type; } keywords[] = {
+			{ "autoidx", T_AUTOIDX }, { "module", T_MODULE }, { "attribute", T_ATTRIBUTE },
+			{ "parameter", T_PARAMETER }, { "signed", T_SIGNED }, { "real", T_REAL },
+			{ "wire", T_WIRE }, { "memory", T_MEMORY }, { "width", T_WIDTH },
+			{ "upto", T_UPTO }, { "offset", T_OFFSET }, { "size", T_SIZE },
+			{ "input", T_INPUT }, { "output", T_OUTPUT }, { "inout", T_INOUT },
+			{ "cell", T_CELL }, { "connect", T_CONNECT }, { "switch", T_SWITCH },
+			{ "case", T_CASE }, { "assign", T_ASSIGN }, { "sync", T_SYNC },
+			{ "low", T_LOW }, { "high", T_HIGH }, { "posedge", T_POSEDGE },
+			{ "negedge", T_NEGEDGE }, { "edge", T_EDGE }, { "always", T_ALWAYS },
+			{ "global", T_GLOBAL }, { "init", T_INIT }, { "update", T_UPDATE },
+			{ "memwr", T_MEMWR }, { "process", T_PROCESS }, { "end", T_END },
+		};
+		for (auto &kw : keywords)
+			if (kw.name[0] == p[0] && strncmp(kw.name, p, len) == 0 && kw.name[len] == 0)
+				return kw.type;
+		return T_INVALID;
+	}
+
+	static bool is_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	void lex()
+	{
+		while (ptr < end) {
+			if (*ptr == ' ' || *ptr == '\t') {
+				ptr++;
+			} else if (*ptr == '#') {
+				while (ptr < end && *ptr != '\n')
+					ptr++;
+			} else
+				break;
+		}
+
+		tok.str = ptr;
+		tok.len = 0;
+		tok.integer = 0;
+
+		if (ptr == end) {
+			tok.type = T_EOF;
+			return;
+		}
+
+		char c = *ptr;
+
+		if (c == '\r' || c == '\n') {
+			while (ptr < end && (*ptr == '\r' || *ptr == '\n'))
+				if (*(ptr++) == '\n')
+					line_count++;
+			tok.type = T_EOL;
+			return;
+		}
+
+		if ('a' <= c && c <= 'z') {
+			while (ptr < end && 'a' <= *ptr && *ptr <= 'z')
+				ptr++;
+			tok.len = ptr - tok.str;
+			tok.type = keyword(tok.str, tok.len);
+			return;
+		}
+
+		if ((c == '\\' || c == '$') && ptr+1 < end && !is_space(ptr[1])) {
+			while (ptr < end && !is_space(*ptr))
+				ptr++;
+			tok.len = ptr - tok.str;
+			tok.type = T_ID;
+			return;
+		}
+
+		bool negative = c == '-' && ptr+1 < end && '0' <= ptr[1] && ptr[1] <= '9';
+		if (('0' <= c && c <= '9') || negative) {
+			if (negative)
+				ptr++;
+			while (ptr < end && '0' <= *ptr && *ptr <= '9')
+				ptr++;
+			if (!negative && ptr < end && *ptr == '\'') {
+				ptr++;
+				while (ptr < end && (*ptr == '0' || *ptr == '1' || *ptr == 'x' || *ptr == 'z' || *ptr == 'm' || *ptr == '-'))
+					ptr++;
+				tok.len = ptr - tok.str;
+				tok.type = T_VALUE;
+				return;
+			}
+			tok.len = ptr - tok.str;
+			char saved = *ptr;
+			*ptr = 0;
+			errno = 0;
+			long value = strtol(tok.str, nullptr, 10);
+			*ptr = saved;
+			if (errno == ERANGE || value < INT_MIN || value > INT_MAX) {
+				tok.type = T_INVALID;
+				return;
+			}
+			tok.integer = value;
+			tok.type = T_INT;
+			return;
+		}
+
+		if (c == '"') {
+			// Unescape in place: the unescaped string is never longer than the
+			// quoted one, so it fits into the buffer where the token was.
+			char *out = ++ptr;
+			tok.str = out;
+			while (ptr < end && *ptr != '"') {
+				if (*ptr == '\\' && ptr+1 < end) {
+					ptr++;
+					if (*ptr == 'n') {
+						*(out++) = '\n';
+						ptr++;
+					} else if (*ptr == 't') {
+						*(out++) = '\t';
+						ptr++;
+					} else if ('0' <= *ptr && *ptr <= '7') {
+						int value = *(ptr++) - '0';
+						for (int i = 0; i < 2 && ptr < end && '0' <= *ptr && *ptr <= '7'; i++)
+							value = value * 8 + *(ptr++) - '0';
+						*(out++) = value;
+					} else
+						*(out++) = *(ptr++);
+					continue;
+				}
+				if (*ptr == '\n')
+					line_count++;
+				*(out++) = *(ptr++);
+			}
+			if (ptr == end)
+				error("unterminated string");
+			ptr++;
+			tok.len = out - tok.str;
+			tok.type = T_STRING;
+			return;
+		}
+
+		ptr++;
+		tok.len = 1;
+		tok.type = T_CHAR;
+	}
+
+	const Token &peek()
+	{
+		if (!have_tok) {
+			lex();
+			have_tok = true;
+		}
+		return tok;
+	}
+
+	Token next()
+	{
+		peek();
+		have_tok = false;
+		return tok;
+	}
+
+	bool peek_char(char c)
+	{
+		return peek().type == T_CHAR && tok.str[0] == c;
+	}
+
+	Token expect(TokenType type)
+	{
+		Token t = next();
+		if (t.type != type)
+			error("syntax error");
+		return t;
+	}
+
+	void expect_char(char c)
+	{
+		if (!peek_char(c))
+			error("syntax error");
+		next();
+	}
+
+	void expect_eol()
+	{
+		expect(T_EOL);
+		while (peek().type == T_EOL)
+			next();
+	}
+
+	std::string str(const Token &t)
+	{
+		return std::string(t.str, t.len);
+	}
+
+	RTLIL::IdString id(const Token &t)
+	{
+		// Tokens point into our own buffer, so terminate them in place
+		// instead of copying them into a std::string first.
+		char saved = t.str[t.len];
+		t.str[t.len] = 0;
+		RTLIL::IdString result(t.str);
+		t.str[t.len] = saved;
+		return result;
+	}
+
+	RTLIL::IdString expect_id()
+	{
+		return id(expect(T_ID));
+	}
+
+	int expect_int()
+	{
+		return expect(T_INT).integer;
+	}
+
+	RTLIL::Const parse_const()
+	{
+		Token t = next();
+
+		if (t.type == T_INT)
+			return RTLIL::Const(t.integer, 32);
+
+		if (t.type == T_STRING)
+			return RTLIL::Const(str(t));
+
+		if (t.type != T_VALUE)
+			error("syntax error");
+
+		const char *p = t.str, *e = t.str + t.len;
+		long width = 0;
+		while (*p != '\'')
+			width = width * 10 + *(p++) - '0';
+		p++;
+
+		RTLIL::Const result;
+		result.bits.reserve(width);
+		for (const char *q = e; q > p && GetSize(result.bits) < width; ) {
+			switch (*(--q)) {
+			case '0': result.bits.push_back(RTLIL::S0); break;
+			case '1': result.bits.push_back(RTLIL::S1); break;
+			case 'z': result.bits.push_back(RTLIL::Sz); break;
+			case '-': result.bits.push_back(RTLIL::Sa); break;
+			case 'm': result.bits.push_back(RTLIL::Sm); break;
+			default: result.bits.push_back(RTLIL::Sx); break;
+			}
+		}
+
+		// Extend with the most significant bit, except that 1 extends with 0.
+		RTLIL::State ext = RTLIL::Sx;
+		if (p < e) {
+			switch (*p) {
+			case '0': case '1': ext = RTLIL::S0; break;
+			case 'z': ext = RTLIL::Sz; break;
+			case '-': ext = RTLIL::Sa; break;
+			case 'm': ext = RTLIL::Sm; break;
+			default: ext = RTLIL::Sx; break;
+			}
+		}
+		while (GetSize(result.bits) < width)
+			result.bits.push_back(ext);
+
+		return result;
+	}
+
+	bool peek_const()
+	{
+		TokenType type = peek().type;
+		return type == T_VALUE || type == T_INT || type == T_STRING;
+	}
+
+	RTLIL::SigSpec parse_sigspec()
+	{
+		RTLIL::SigSpec sig;
+
+		if (peek_char('{')) {
+			next();
+			std::vector<RTLIL::SigSpec> parts;
+			while (!peek_char('}'))
+				parts.push_back(parse_sigspec());
+			next();
+			for (auto it = parts.rbegin(); it != parts.rend(); it++)
+				sig.append(*it);
+		} else if (peek().type == T_ID) {
+			Token t = next();
+			RTLIL::Wire *wire = module->wire(id(t));
+			if (wire == nullptr)
+				error(stringf("RTLIL error: wire %s not found", str(t).c_str()));
+			sig = RTLIL::SigSpec(wire);
+		} else if (peek_const()) {
+			sig = RTLIL::SigSpec(parse_const());
+		} else
+			error("syntax error");
+
+		while (peek_char('[')) {
+			next();
+			int left = expect_int();
+			if (peek_char(':')) {
+				next();
+				int right = expect_int();
+				if (left >= sig.size() || left < 0 || left < right)
+					error("invalid slice");
+				sig = sig.extract(right, left - right + 1);
+			} else {
+				if (left >= sig.size() || left < 0)
+					error("bit index out of range");
+				sig = sig.extract(left);
+			}
+			expect_char(']');
+		}
+
+		return sig;
+	}
+
+	void check_dangling_attributes()
+	{
+		if (!attrbuf.empty())
+			error("dangling attribute");
+	}
+
+	void parse_attr_stmt()
+	{
+		expect(T_ATTRIBUTE);
+		RTLIL::IdString name = expect_id();
+		attrbuf[name] = parse_const();
+		expect_eol();
+	}
+
+	void parse_wire_stmt()
+	{
+		expect(T_WIRE);
+
+		int width = 1, start_offset = 0, port_id = 0;
+		bool upto = false, is_signed = false, port_input = false, port_output = false;
+
+		while (1) {
+			TokenType type = peek().type;
+			if (type == T_WIDTH) {
+				next();
+				if (peek().type == T_INVALID)
+					error("RTLIL error: invalid wire width");
+				width = expect_int();
+			} else if (type == T_UPTO) {
+				next();
+				upto = true;
+			} else if (type == T_SIGNED) {
+				next();
+				is_signed = true;
+			} else if (type == T_OFFSET) {
+				next();
+				start_offset = expect_int();
+			} else if (type == T_INPUT || type == T_OUTPUT || type == T_INOUT) {
+				next();
+				port_id = expect_int();
+				port_input = type != T_OUTPUT;
+				port_output = type != T_INPUT;
+			} else
+				break;
+		}
+
+		Token t = expect(T_ID);
+		RTLIL::IdString name = id(t);
+		expect_eol();
+
+		if (module->wire(name) != nullptr)
+			error(stringf("RTLIL error: redefinition of wire %s.", str(t).c_str()));
+
+		RTLIL::Wire *wire = module->addWire(name, width);
+		wire->start_offset = start_offset;
+		wire->port_id = port_id;
+		wire->port_input = port_input;
+		wire->port_output = port_output;
+		wire->upto = upto;
+		wire->is_signed = is_signed;
+		wire->attributes.swap(attrbuf);
+		attrbuf.clear();
+	}
+
+	void parse_memory_stmt()
+	{
+		expect(T_MEMORY);
+
+		RTLIL::Memory *memory = new RTLIL::Memory;
+		memory->attributes.swap(attrbuf);
+		attrbuf.clear();
+
+		while (1) {
+			TokenType type = peek().type;
+			if (type == T_WIDTH) {
+				next();
+				memory->width = expect_int();
+			} else if (type == T_SIZE) {
+				next();
+				memory->size = expect_int();
+			} else if (type == T_OFFSET) {
+				next();
+				memory->start_offset = expect_int();
+			} else
+				break;
+		}
+
+		Token t = expect(T_ID);
+		RTLIL::IdString name = id(t);
+		expect_eol();
+
+		if (module->memories.count(name) != 0)
+			error(stringf("RTLIL error: redefinition of memory %s.", str(t).c_str()));
+		memory->name = name;
+		module->memories[name] = memory;
+	}
+
+	void parse_cell_stmt()
+	{
+		expect(T_CELL);
+		RTLIL::IdString type = expect_id();
+		Token t = expect(T_ID);
+		RTLIL::IdString name = id(t);
+		expect_eol();
+
+		if (module->cell(name) != nullptr)
+			error(stringf("RTLIL error: redefinition of cell %s.", str(t).c_str()));
+		RTLIL::Cell *cell = module->addCell(name, type);
+		cell->attributes.swap(attrbuf);
+		attrbuf.clear();
+
+		while (1) {
+			TokenType type = peek().type;
+			if (type == T_PARAMETER) {
+				next();
+				int flags = 0;
+				if (peek().type == T_SIGNED) {
+					next();
+					flags = RTLIL::CONST_FLAG_SIGNED;
+				} else if (peek().type == T_REAL) {
+					next();
+					flags = RTLIL::CONST_FLAG_REAL;
+				}
+				RTLIL::IdString param = expect_id();
+				RTLIL::Const &value = cell->parameters[param];
+				value = parse_const();
+				value.flags |= flags;
+				expect_eol();
+			} else if (type == T_CONNECT) {
+				next();
+				Token p = expect(T_ID);
+				RTLIL::IdString port = id(p);
+				RTLIL::SigSpec sig = parse_sigspec();
+				expect_eol();
+				if (cell->hasPort(port))
+					error(stringf("RTLIL error: redefinition of cell port %s.", str(p).c_str()));
+				cell->setPort(port, sig);
+			} else
+				break;
+		}
+
+		expect(T_END);
+		expect_eol();
+	}
+
+	void parse_case_body(RTLIL::CaseRule *rule)
+	{
+		while (1) {
+			TokenType type = peek().type;
+			if (type == T_ATTRIBUTE) {
+				parse_attr_stmt();
+			} else if (type == T_SWITCH) {
+				parse_switch_stmt(rule);
+			} else if (type == T_ASSIGN) {
+				next();
+				check_dangling_attributes();
+				RTLIL::SigSpec lhs = parse_sigspec();
+				RTLIL::SigSpec rhs = parse_sigspec();
+				expect_eol();
+				rule->actions.push_back(RTLIL::SigSig(lhs, rhs));
+			} else
+				break;
+		}
+	}
+
+	void parse_switch_stmt(RTLIL::CaseRule *parent)
+	{
+		expect(T_SWITCH);
+		RTLIL::SwitchRule *rule = new RTLIL::SwitchRule;
+		rule->signal = parse_sigspec();
+		rule->attributes.swap(attrbuf);
+		attrbuf.clear();
+		parent->switches.push_back(rule);
+		expect_eol();
+
+		while (peek().type == T_ATTRIBUTE)
+			parse_attr_stmt();
+
+		while (peek().type == T_CASE) {
+			next();
+			RTLIL::CaseRule *case_rule = new RTLIL::CaseRule;
+			case_rule->attributes.swap(attrbuf);
+			attrbuf.clear();
+			rule->cases.push_back(case_rule);
+			if (peek().type != T_EOL) {
+				// the grammar's compare list may start with an empty item
+				if (peek_char(','))
+					next();
+				case_rule->compare.push_back(parse_sigspec());
+				while (peek_char(',')) {
+					next();
+					case_rule->compare.push_back(parse_sigspec());
+				}
+			}
+			expect_eol();
+			parse_case_body(case_rule);
+		}
+
+		expect(T_END);
+		expect_eol();
+	}
+
+	void parse_proc_stmt()
+	{
+		expect(T_PROCESS);
+		Token t = expect(T_ID);
+		RTLIL::IdString name = id(t);
+		expect_eol();
+
+		if (module->processes.count(name) != 0)
+			error(stringf("RTLIL error: redefinition of process %s.", str(t).c_str()));
+		RTLIL::Process *proc = module->addProcess(name);
+		proc->attributes.swap(attrbuf);
+		attrbuf.clear();
+
+		parse_case_body(&proc->root_case);
+
+		while (peek().type == T_SYNC) {
+			next();
+			RTLIL::SyncRule *rule = new RTLIL::SyncRule;
+			proc->syncs.push_back(rule);
+			switch (next().type) {
+			case T_LOW: rule->type = RTLIL::ST0; break;
+			case T_HIGH: rule->type = RTLIL::ST1; break;
+			case T_POSEDGE: rule->type = RTLIL::STp; break;
+			case T_NEGEDGE: rule->type = RTLIL::STn; break;
+			case T_EDGE: rule->type = RTLIL::STe; break;
+			case T_ALWAYS: rule->type = RTLIL::STa; break;
+			case T_GLOBAL: rule->type = RTLIL::STg; break;
+			case T_INIT: rule->type = RTLIL::STi; break;
+			default: error("syntax error");
+			}
+			if (rule->type != RTLIL::STa && rule->type != RTLIL::STg && rule->type != RTLIL::STi)
+				rule->signal = parse_sigspec();
+			expect_eol();
+
+			while (1) {
+				TokenType type = peek().type;
+				if (type == T_UPDATE) {
+					next();
+					RTLIL::SigSpec lhs = parse_sigspec();
+					RTLIL::SigSpec rhs = parse_sigspec();
+					expect_eol();
+					rule->actions.push_back(RTLIL::SigSig(lhs, rhs));
+				} else if (type == T_ATTRIBUTE) {
+					parse_attr_stmt();
+				} else if (type == T_MEMWR) {
+					next();
+					RTLIL::MemWriteAction act;
+					act.attributes.swap(attrbuf);
+					attrbuf.clear();
+					act.memid = expect_id();
+					act.address = parse_sigspec();
+					act.data = parse_sigspec();
+					act.enable = parse_sigspec();
+					act.priority_mask = parse_const();
+					expect_eol();
+					rule->mem_write_actions.push_back(std::move(act));
+				} else
+					break;
+			}
+			check_dangling_attributes();
+		}
+
+		expect(T_END);
+		expect_eol();
+	}
+
+	void parse_module()
+	{
+		expect(T_MODULE);
+		Token t = expect(T_ID);
+		RTLIL::IdString name = id(t);
+		std::string name_str = str(t);
+		expect_eol();
+
+		bool delete_current_module = false;
+		if (design->has(name)) {
+			RTLIL::Module *existing_mod = design->module(name);
+			if (!flag_overwrite && (flag_lib || (attrbuf.count(ID::blackbox) && attrbuf.at(ID::blackbox).as_bool()))) {
+				log("Ignoring blackbox re-definition of module %s.\n", name_str.c_str());
+				delete_current_module = true;
+			} else if (!flag_nooverwrite && !flag_overwrite && !existing_mod->get_bool_attribute(ID::blackbox)) {
+				error(stringf("RTLIL error: redefinition of module %s.", name_str.c_str()));
+			} else if (flag_nooverwrite) {
+				log("Ignoring re-definition of module %s.\n", name_str.c_str());
+				delete_current_module = true;
+			} else {
+				log("Replacing existing%s module %s.\n", existing_mod->get_bool_attribute(ID::blackbox) ? " blackbox" : "", name_str.c_str());
+				design->remove(existing_mod);
+			}
+		}
+
+		module = new RTLIL::Module;
+		module->name = name;
+		module->attributes.swap(attrbuf);
+		attrbuf.clear();
+		if (!delete_current_module)
+			design->add(module);
+
+		while (1) {
+			switch (peek().type) {
+			case T_PARAMETER: {
+				next();
+				RTLIL::IdString param = expect_id();
+				module->avail_parameters(param);
+				if (peek_const())
+					module->parameter_default_values[param] = parse_const();
+				expect_eol();
+				break;
+			}
+			case T_ATTRIBUTE: parse_attr_stmt(); break;
+			case T_WIRE: parse_wire_stmt(); break;
+			case T_MEMORY: parse_memory_stmt(); break;
+			case T_CELL: parse_cell_stmt(); break;
+			case T_PROCESS: parse_proc_stmt(); break;
+			case T_CONNECT: {
+				next();
+				check_dangling_attributes();
+				RTLIL::SigSpec lhs = parse_sigspec();
+				RTLIL::SigSpec rhs = parse_sigspec();
+				expect_eol();
+				module->connect(lhs, rhs);
+				break;
+			}
+			case T_END:
+				goto end_of_module;
+			default:
+				error("syntax error");
+			}
+		}
+
+	end_of_module:
+		next();
+		check_dangling_attributes();
+		module->fixup_ports();
+		if (delete_current_module)
+			delete module;
+		else if (flag_lib)
+			module->makeblackbox();
+		module = nullptr;
+		expect_eol();
+	}
+
+	void parse()
+	{
+		while (peek().type == T_EOL)
+			next();
+
+		while (1) {
+			switch (peek().type) {
+			case T_MODULE:
+				parse_module();
+				break;
+			case T_ATTRIBUTE:
+				parse_attr_stmt();
+				break;
+			case T_AUTOIDX:
+				next();
+				autoidx = max(autoidx, expect_int());
+				expect_eol();
+				break;
+			case T_EOF:
+				check_dangling_attributes();
+				return;
+			default:
+				error("syntax error");
+			}
+		}
+	}
+};
+
+} /* namespace */
+
+void RTLIL_FRONTEND::fast_parse(std::istream &f, RTLIL::Design *design)
+{
+	RTLILFastParser parser(f, design, flag_nooverwrite, flag_overwrite, flag_lib);
+	parser.parse();
+}
+
+YOSYS_NAMESPACE_END
@@ -55,12 +55,18 @@ struct RTLILFrontend : public Frontend {
 		log("    -lib\n");
 		log("        only create empty blackbox modules\n");
 		log("\n");
+		log("    -fast\n");
+		log("        use the hand-written reader instead of the flex/bison parser. it\n");
+		log("        accepts the same input, but reads the file into a single buffer and\n");
+		log("        tokenizes it in place, which is considerably faster for large files.\n");
+		log("\n");
 	}
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		RTLIL_FRONTEND::flag_nooverwrite = false;
 		RTLIL_FRONTEND::flag_overwrite = false;
 		RTLIL_FRONTEND::flag_lib = false;
+		bool flag_fast = false;
 
 		log_header(design, "Executing RTLIL frontend.\n");
 
@@ -81,12 +87,21 @@ struct RTLILFrontend : public Frontend {
 				RTLIL_FRONTEND::flag_lib = true;
 				continue;
 			}
+			if (arg == "-fast") {
+				flag_fast = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
 		log("Input filename: %s\n", filename.c_str());
 
+		if (flag_fast) {
+			RTLIL_FRONTEND::fast_parse(*f, design);
+			return;
+		}
+
 		RTLIL_FRONTEND::lexin = f;
 		RTLIL_FRONTEND::current_design = design;
 		rtlil_frontend_yydebug = false;
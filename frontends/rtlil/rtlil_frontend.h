@@ -35,6 +35,9 @@ namespace RTLIL_FRONTEND {
 	extern bool flag_nooverwrite;
 	extern bool flag_overwrite;
 	extern bool flag_lib;
+
+	// implemented in rtlil_fastparse.cc
+	void fast_parse(std::istream &f, RTLIL::Design *design);
 }
 
 YOSYS_NAMESPACE_END
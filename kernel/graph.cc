@@ -0,0 +1,219 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// [[CITE]] Tarjan's strongly connected components algorithm
+// Tarjan, R. E. (1972), "Depth-first search and linear graph algorithms", SIAM Journal on Computing 1 (2): 146-160, doi:10.1137/0201010
+// http://en.wikipedia.org/wiki/Tarjan's_strongly_connected_components_algorithm
+
+#include "kernel/graph.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+void IntGraph::build()
+{
+	// Bucket the edges by source node, then sort each bucket by target
+	std::vector<int> slot_first(num_nodes + 1), slots(GetSize(edges));
+
+	for (auto &edge : edges) {
+		log_assert(edge.first >= 0 && edge.first < num_nodes);
+		log_assert(edge.second >= 0 && edge.second < num_nodes);
+		slot_first[edge.first + 1]++;
+	}
+	for (int n = 0; n < num_nodes; n++)
+		slot_first[n + 1] += slot_first[n];
+
+	std::vector<int> slot_pos(slot_first.begin(), slot_first.end() - 1);
+	for (int i = 0; i < GetSize(edges); i++)
+		slots[slot_pos[edges[i].first]++] = i;
+
+	first.assign(num_nodes + 1, 0);
+	succ.clear();
+	edge_index.clear();
+	succ.reserve(GetSize(edges));
+	edge_index.reserve(GetSize(edges));
+
+	for (int n = 0; n < num_nodes; n++)
+	{
+		auto begin = slots.begin() + slot_first[n], end = slots.begin() + slot_first[n + 1];
+		std::stable_sort(begin, end, [&](int a, int b) { return edges[a].second < edges[b].second; });
+
+		first[n] = GetSize(succ);
+		for (auto it = begin; it != end; ++it) {
+			int target = edges[*it].second;
+			if (GetSize(succ) > first[n] && succ.back() == target)
+				continue;
+			succ.push_back(target);
+			edge_index.push_back(*it);
+		}
+	}
+	first[num_nodes] = GetSize(succ);
+}
+
+IntGraph IntGraph::reversed() const
+{
+	IntGraph graph(num_nodes);
+	graph.edges.reserve(GetSize(edges));
+	for (auto &edge : edges)
+		graph.edges.emplace_back(edge.second, edge.first);
+	graph.build();
+	return graph;
+}
+
+int IntGraph::scc(std::vector<int> &component, int max_depth) const
+{
+	log_assert(GetSize(first) == num_nodes + 1);
+
+	std::vector<int> index(num_nodes, -1), lowlink(num_nodes), depth(num_nodes);
+	std::vector<bool> on_stack(num_nodes);
+	std::vector<int> stack;
+
+	// The search stack: a node and the position of its next outgoing edge
+	std::vector<std::pair<int, int>> dfs;
+
+	component.assign(num_nodes, -1);
+	int counter = 0, num_components = 0;
+
+	auto visit = [&](int node, int node_depth) {
+		index[node] = lowlink[node] = counter++;
+		depth[node] = node_depth;
+		stack.push_back(node);
+		on_stack[node] = true;
+		dfs.emplace_back(node, first[node]);
+	};
+
+	for (int root = 0; root < num_nodes; root++)
+	{
+		if (index[root] >= 0)
+			continue;
+
+		visit(root, 0);
+
+		while (!dfs.empty())
+		{
+			int node = dfs.back().first;
+
+			if (dfs.back().second < first[node + 1]) {
+				int next = succ[dfs.back().second++];
+				if (index[next] < 0)
+					visit(next, depth[node] + 1);
+				else if (on_stack[next] && (max_depth < 0 || depth[next] + max_depth > depth[node]))
+					lowlink[node] = std::min(lowlink[node], lowlink[next]);
+				continue;
+			}
+
+			dfs.pop_back();
+			if (!dfs.empty()) {
+				int parent = dfs.back().first;
+				lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+			}
+
+			if (lowlink[node] == index[node]) {
+				int member;
+				do {
+					member = stack.back();
+					stack.pop_back();
+					on_stack[member] = false;
+					component[member] = num_components;
+				} while (member != node);
+				num_components++;
+			}
+		}
+	}
+
+	return num_components;
+}
+
+std::vector<bool> IntGraph::back_edges() const
+{
+	log_assert(GetSize(first) == num_nodes + 1);
+
+	std::vector<bool> back(GetSize(succ));
+	std::vector<bool> visited(num_nodes), on_stack(num_nodes);
+	std::vector<std::pair<int, int>> dfs;
+
+	// Start at the nodes without predecessors, so that loops are cut as
+	// far away from them as possible
+	std::vector<bool> has_pred(num_nodes);
+	for (int s : succ)
+		has_pred[s] = true;
+
+	std::vector<int> roots;
+	for (int n = 0; n < num_nodes; n++)
+		if (!has_pred[n])
+			roots.push_back(n);
+	for (int n = 0; n < num_nodes; n++)
+		if (has_pred[n])
+			roots.push_back(n);
+
+	for (int root : roots)
+	{
+		if (visited[root])
+			continue;
+
+		visited[root] = on_stack[root] = true;
+		dfs.emplace_back(root, first[root]);
+
+		while (!dfs.empty())
+		{
+			int node = dfs.back().first;
+
+			if (dfs.back().second < first[node + 1]) {
+				int k = dfs.back().second++;
+				int next = succ[k];
+				if (on_stack[next])
+					back[k] = true;
+				else if (!visited[next]) {
+					visited[next] = on_stack[next] = true;
+					dfs.emplace_back(next, first[next]);
+				}
+				continue;
+			}
+
+			on_stack[node] = false;
+			dfs.pop_back();
+		}
+	}
+
+	return back;
+}
+
+bool IntGraph::topo_order(std::vector<int> &order) const
+{
+	log_assert(GetSize(first) == num_nodes + 1);
+
+	std::vector<int> indegree(num_nodes);
+	for (int s : succ)
+		indegree[s]++;
+
+	order.clear();
+	for (int n = 0; n < num_nodes; n++)
+		if (indegree[n] == 0)
+			order.push_back(n);
+
+	for (int i = 0; i < GetSize(order); i++) {
+		int node = order[i];
+		for (int k = first[node]; k < first[node + 1]; k++)
+			if (--indegree[succ[k]] == 0)
+				order.push_back(succ[k]);
+	}
+
+	return GetSize(order) == num_nodes;
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,78 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// A directed graph on the nodes 0 .. num_nodes-1. Edges are collected with
+// add_edge() and then packed by build() into compressed sparse row form: the
+// successors of node n are succ[first[n]] .. succ[first[n+1]-1], sorted by
+// node id and without duplicates. None of the algorithms recurse, so they
+// work on arbitrarily deep netlists.
+struct IntGraph
+{
+	int num_nodes = 0;
+	std::vector<std::pair<int, int>> edges;
+	std::vector<int> first, succ;
+
+	// For every entry of succ, the index into edges of the first add_edge()
+	// call that created it, e.g. to look up a cell or weight for the edge
+	std::vector<int> edge_index;
+
+	IntGraph(int num_nodes = 0) : num_nodes(num_nodes) { }
+
+	int add_node() { return num_nodes++; }
+	void add_edge(int from, int to) { edges.emplace_back(from, to); }
+	void build();
+
+	int fanout(int node) const { return first[node+1] - first[node]; }
+	bool has_edge(int from, int to) const {
+		return std::binary_search(succ.begin() + first[from], succ.begin() + first[from+1], to);
+	}
+
+	// The graph with all edges reversed, already built
+	IntGraph reversed() const;
+
+	// Strongly connected components by Tarjan's algorithm. Stores the
+	// component of every node and returns the number of components.
+	// Components are numbered in the order they are completed, so that all
+	// nodes reachable from a component are in components with smaller or
+	// equal numbers. If max_depth is non-negative, an edge back into the
+	// search stack only closes a loop if it reaches at most max_depth levels
+	// up the search tree (see "scc -max_depth").
+	int scc(std::vector<int> &component, int max_depth = -1) const;
+
+	// Marks the entries of succ that lead back into the stack of a
+	// depth-first search started at the nodes without predecessors.
+	// Without these edges the graph is acyclic.
+	std::vector<bool> back_edges() const;
+
+	// Nodes in topological order, i.e. every node before its successors.
+	// Returns false if the graph has a cycle, in which case the nodes on or
+	// behind a cycle are missing from the order.
+	bool topo_order(std::vector<int> &order) const;
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -28,23 +28,70 @@
 #ifdef YOSYS_ENABLE_ZLIB
 #include <zlib.h>
 
+YOSYS_NAMESPACE_BEGIN
 PRIVATE_NAMESPACE_BEGIN
-#define GZ_BUFFER_SIZE 8192
-void decompress_gzip(const std::string &filename, std::stringstream &out)
-{
-	char buffer[GZ_BUFFER_SIZE];
-	int bytes_read;
-	gzFile gzf = gzopen(filename.c_str(), "rb");
-	while(!gzeof(gzf)) {
-		bytes_read = gzread(gzf, reinterpret_cast<void *>(buffer), GZ_BUFFER_SIZE);
-		out.write(buffer, bytes_read);
+#define GZ_BUFFER_SIZE 65536
+#define GZ_PUTBACK_SIZE 16
+
+/*
+An input stream that decompresses a gzip file on the fly, so that the
+decompressed data never has to be held in memory as a whole.
+*/
+class gzip_istream : public std::istream  {
+public:
+	gzip_istream() : std::istream(nullptr)
+	{
+		rdbuf(&inbuf);
 	}
-	gzclose(gzf);
-}
+	bool open(const std::string &filename)
+	{
+		return inbuf.open(filename);
+	}
+private:
+	class gzip_streambuf : public std::streambuf {
+	public:
+		gzip_streambuf() { };
+		bool open(const std::string &filename)
+		{
+			gzf = gzopen(filename.c_str(), "rb");
+			if (gzf == nullptr)
+				return false;
+			gzbuffer(gzf, GZ_BUFFER_SIZE);
+			return true;
+		}
+		virtual int_type underflow() override
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
+			// keep the tail of the previous block around for unget()
+			int putback = std::min(int(gptr() - eback()), GZ_PUTBACK_SIZE);
+			if (putback > 0)
+				memmove(buffer + GZ_PUTBACK_SIZE - putback, gptr() - putback, putback);
+			int bytes_read = gzread(gzf, buffer + GZ_PUTBACK_SIZE, GZ_BUFFER_SIZE - GZ_PUTBACK_SIZE);
+			if (bytes_read < 0) {
+				int errnum;
+				log_error("Error while decompressing gzip input: %s\n", gzerror(gzf, &errnum));
+			}
+			if (bytes_read == 0)
+				return traits_type::eof();
+			setg(buffer + GZ_PUTBACK_SIZE - putback, buffer + GZ_PUTBACK_SIZE, buffer + GZ_PUTBACK_SIZE + bytes_read);
+			return traits_type::to_int_type(*gptr());
+		}
+		virtual ~gzip_streambuf()
+		{
+			if (gzf != nullptr)
+				gzclose(gzf);
+		}
+	private:
+		char buffer[GZ_BUFFER_SIZE];
+		gzFile gzf = nullptr;
+	} inbuf;
+};
 
 /*
-An output stream that uses a stringbuf to buffer data internally,
-using zlib to write gzip-compressed data every time the stream is flushed.
+An output stream that collects data in a fixed-size buffer and uses zlib
+to write gzip-compressed data every time the buffer fills up or the stream
+is flushed.
 */
 class gzip_ostream : public std::ostream  {
 public:
@@ -57,30 +104,65 @@ public:
 		return outbuf.open(filename);
 	}
 private:
-	class gzip_streambuf : public std::stringbuf {
+	class gzip_streambuf : public std::streambuf {
 	public:
-		gzip_streambuf() { };
+		gzip_streambuf()
+		{
+			setp(buffer, buffer + GZ_BUFFER_SIZE);
+		}
 		bool open(const std::string &filename)
 		{
 			gzf = gzopen(filename.c_str(), "wb");
-			return gzf != nullptr;
+			if (gzf == nullptr)
+				return false;
+			gzbuffer(gzf, GZ_BUFFER_SIZE);
+			return true;
+		}
+		virtual int_type overflow(int_type c) override
+		{
+			if (flush_buffer() < 0)
+				return traits_type::eof();
+			if (!traits_type::eq_int_type(c, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(c);
+				pbump(1);
+			}
+			return traits_type::not_eof(c);
+		}
+		virtual std::streamsize xsputn(const char *s, std::streamsize n) override
+		{
+			if (n < GZ_BUFFER_SIZE)
+				return std::streambuf::xsputn(s, n);
+			// large blocks go straight to zlib instead of being copied
+			if (flush_buffer() < 0 || gzwrite(gzf, s, unsigned(n)) != int(n))
+				return 0;
+			return n;
 		}
 		virtual int sync() override
 		{
-			gzwrite(gzf, reinterpret_cast<const void *>(str().c_str()), unsigned(str().size()));
-			str("");
-			return 0;
+			return flush_buffer();
 		}
 		virtual ~gzip_streambuf()
 		{
-			sync();
-			gzclose(gzf);
+			if (gzf != nullptr) {
+				sync();
+				gzclose(gzf);
+			}
 		}
 	private:
+		int flush_buffer()
+		{
+			int n = int(pptr() - pbase());
+			if (n > 0 && gzwrite(gzf, pbase(), unsigned(n)) != n)
+				return -1;
+			pbump(-n);
+			return 0;
+		}
+		char buffer[GZ_BUFFER_SIZE];
 		gzFile gzf = nullptr;
 	} outbuf;
 };
 PRIVATE_NAMESPACE_END
+YOSYS_NAMESPACE_END
 
 #endif
 
@@ -555,9 +637,12 @@ void Frontend::extra_args(std::istream *&f, std::string &filename, std::vector<s
 						log_cmd_error("gzip file `%s' uses unsupported compression type %02x\n",
 							filename.c_str(), unsigned(magic[2]));
 					delete ff;
-					std::stringstream *df = new std::stringstream();
-					decompress_gzip(filename, *df);
-					f = df;
+					gzip_istream *gf = new gzip_istream;
+					if (!gf->open(filename)) {
+						delete gf;
+						log_cmd_error("Can't open input file `%s' for reading: %s\n", filename.c_str(), strerror(errno));
+					}
+					f = gf;
 	#else
 					log_cmd_error("File `%s' is a gzip file, but Yosys is compiled without zlib.\n", filename.c_str());
 	#endif
@@ -1956,6 +1956,10 @@ void RTLIL::Module::cloneInto(RTLIL::Module *new_mod) const
 	new_mod->avail_parameters = avail_parameters;
 	new_mod->parameter_default_values = parameter_default_values;
 
+	new_mod->connections_.reserve(new_mod->connections_.size() + connections_.size());
+	new_mod->wires_.reserve(new_mod->wires_.size() + wires_.size());
+	new_mod->cells_.reserve(new_mod->cells_.size() + cells_.size());
+
 	for (auto &conn : connections_)
 		new_mod->connect(conn);
 
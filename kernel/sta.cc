@@ -0,0 +1,781 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/sta.h"
+#include "kernel/celledges.h"
+#include "kernel/cost.h"
+#include "kernel/macc.h"
+
+#include <limits>
+
+YOSYS_NAMESPACE_BEGIN
+
+static const int STA_UNCONSTRAINED = std::numeric_limits<int>::max();
+
+struct StaEdgesDatabase : AbstractCellEdgesDatabase
+{
+	std::vector<std::tuple<RTLIL::IdString, int, RTLIL::IdString, int>> edges;
+
+	void add_edge(RTLIL::Cell*, RTLIL::IdString from_port, int from_bit, RTLIL::IdString to_port, int to_bit, int) override {
+		edges.emplace_back(from_port, from_bit, to_port, to_bit);
+	}
+};
+
+static int tree_depth(int width)
+{
+	return width > 1 ? ceil_log2(width) : 0;
+}
+
+static int adder_delay(int width)
+{
+	const auto &cost = CellCosts::default_gate_cost();
+	return 2*cost.at(ID($_XOR_)) + cost.at(ID($_AND_))*tree_depth(width);
+}
+
+static int csa_delay(int rows)
+{
+	int levels = 0;
+	while (rows > 2) {
+		rows -= rows / 3;
+		levels++;
+	}
+	return 2*CellCosts::default_gate_cost().at(ID($_XOR_))*levels;
+}
+
+int StaEngine::estimate_macc_delay(const Macc &macc, int width)
+{
+	int rows = GetSize(macc.bit_ports) ? 1 : 0;
+	bool has_mul = false;
+	for (auto &port : macc.ports) {
+		if (GetSize(port.in_b)) {
+			rows += std::min(GetSize(port.in_a), GetSize(port.in_b));
+			has_mul = true;
+		} else
+			rows++;
+	}
+	int delay = csa_delay(rows) + adder_delay(width);
+	if (has_mul)
+		delay += CellCosts::default_gate_cost().at(ID($_AND_));
+	return delay;
+}
+
+int StaEngine::estimate_delay(RTLIL::Cell *cell)
+{
+	const auto &cost = CellCosts::default_gate_cost();
+	auto it = cost.find(cell->type);
+	if (it != cost.end())
+		return it->second;
+
+	const int gate = cost.at(ID($_AND_));
+	const int mux = cost.at(ID($_MUX_));
+	const int xor_gate = cost.at(ID($_XOR_));
+
+	auto width = [&](RTLIL::IdString port) {
+		return cell->hasPort(port) ? GetSize(cell->getPort(port)) : 0;
+	};
+	int a_width = width(ID::A), b_width = width(ID::B), y_width = width(ID::Y);
+
+	if (cell->type == ID($_MUX4_))
+		return 2*mux;
+	if (cell->type == ID($_MUX8_))
+		return 3*mux;
+	if (cell->type == ID($_MUX16_))
+		return 4*mux;
+	if (cell->type.in(ID($pos), ID($concat), ID($slice)))
+		return 0;
+	if (cell->type == ID($not))
+		return cost.at(ID($_NOT_));
+	if (cell->type.in(ID($and), ID($or)))
+		return gate;
+	if (cell->type.in(ID($xor), ID($xnor)))
+		return xor_gate;
+	if (cell->type.in(ID($reduce_and), ID($reduce_or), ID($reduce_bool), ID($logic_not)))
+		return gate*std::max(1, tree_depth(a_width));
+	if (cell->type.in(ID($reduce_xor), ID($reduce_xnor)))
+		return xor_gate*std::max(1, tree_depth(a_width));
+	if (cell->type.in(ID($logic_and), ID($logic_or)))
+		return gate*(tree_depth(std::max(a_width, b_width)) + 1);
+	if (cell->type.in(ID($eq), ID($ne), ID($eqx), ID($nex)))
+		return xor_gate + gate*tree_depth(std::max(a_width, b_width));
+	if (cell->type.in(ID($lt), ID($le), ID($ge), ID($gt)))
+		return adder_delay(std::max(a_width, b_width));
+	if (cell->type.in(ID($add), ID($sub), ID($neg), ID($alu)))
+		return adder_delay(y_width);
+	if (cell->type == ID($fa))
+		return 2*xor_gate;
+	if (cell->type == ID($lcu))
+		return 2*gate*tree_depth(width(ID::P));
+	if (cell->type == ID($mul))
+		return gate + csa_delay(std::min(a_width, b_width)) + adder_delay(y_width);
+	if (cell->type == ID($macc))
+		return estimate_macc_delay(Macc(cell), y_width);
+	if (cell->type.in(ID($div), ID($mod), ID($divfloor), ID($modfloor), ID($pow)))
+		return y_width*adder_delay(y_width);
+	if (cell->type.in(ID($shl), ID($shr), ID($sshl), ID($sshr), ID($shift), ID($shiftx)))
+		return mux*std::max(1, b_width);
+	if (cell->type == ID($mux))
+		return mux;
+	if (cell->type == ID($pmux))
+		return gate*(tree_depth(width(ID::S) + 1) + 1);
+	if (cell->type == ID($bmux))
+		return mux*std::max(1, width(ID::S));
+	if (cell->type == ID($demux))
+		return gate*(tree_depth(width(ID::S)) + 1);
+	if (cell->type == ID($lut))
+		return mux*std::max(1, a_width);
+	if (cell->type == ID($sop))
+		return gate*(tree_depth(cell->getParam(ID::DEPTH).as_int()) + tree_depth(a_width) + 1);
+	return gate;
+}
+
+int StaEngine::new_node(RTLIL::SigBit bit)
+{
+	int n = GetSize(node_bits);
+	node_bits.push_back(bit);
+	arrival.push_back(-1);
+	required.push_back(STA_UNCONSTRAINED);
+	is_source.push_back(false);
+	fanin_arcs.emplace_back();
+	fanout_arcs.emplace_back();
+	return n;
+}
+
+int StaEngine::add_node(RTLIL::SigBit bit)
+{
+	auto it = bit_nodes.find(bit);
+	if (it != bit_nodes.end())
+		return it->second;
+	int n = new_node(bit);
+	bit_nodes[bit] = n;
+	return n;
+}
+
+int StaEngine::node(RTLIL::SigBit bit) const
+{
+	auto it = bit_nodes.find(sigmap(bit));
+	return it == bit_nodes.end() ? -1 : it->second;
+}
+
+int StaEngine::arrival_of(RTLIL::SigBit bit) const
+{
+	int n = node(bit);
+	return n < 0 ? -1 : arrival[n];
+}
+
+int StaEngine::required_of(RTLIL::SigBit bit) const
+{
+	int n = node(bit);
+	return n < 0 ? STA_UNCONSTRAINED : required[n];
+}
+
+int StaEngine::slack_of(RTLIL::SigBit bit) const
+{
+	int n = node(bit);
+	if (n < 0 || arrival[n] < 0 || required[n] == STA_UNCONSTRAINED)
+		return STA_UNCONSTRAINED;
+	return required[n] - arrival[n];
+}
+
+void StaEngine::add_arc(RTLIL::Cell *cell, int src, RTLIL::IdString src_port, int dst, RTLIL::IdString dst_port, int delay)
+{
+	int a;
+	if (free_arcs.empty()) {
+		a = GetSize(arcs);
+		arcs.emplace_back();
+	} else {
+		a = free_arcs.back();
+		free_arcs.pop_back();
+	}
+
+	Arc &arc = arcs[a];
+	arc.src = src;
+	arc.dst = dst;
+	arc.delay = delay;
+	arc.cell = cell;
+	arc.src_port = src_port;
+	arc.dst_port = dst_port;
+
+	fanout_arcs[src].push_back(a);
+	fanin_arcs[dst].push_back(a);
+	cell_arcs[cell].push_back(a);
+	dirty_forward.insert(dst);
+	dirty_backward.insert(src);
+}
+
+void StaEngine::add_endpoint(RTLIL::Cell *cell, RTLIL::SigBit bit, RTLIL::IdString port, int setup, RTLIL::SigBit clock)
+{
+	int n = add_node(bit);
+	Endpoint ep;
+	ep.sink = cell;
+	ep.port = port;
+	ep.setup = setup;
+	ep.clock = clock;
+	endpoints[n].push_back(ep);
+	if (cell != nullptr)
+		cell_endpoints[cell].push_back(n);
+	dirty_backward.insert(n);
+}
+
+void StaEngine::add_source(RTLIL::Cell *cell, RTLIL::SigBit bit)
+{
+	int n = add_node(bit);
+	is_source[n] = true;
+	if (cell != nullptr)
+		cell_sources[cell].push_back(n);
+	dirty_forward.insert(n);
+}
+
+void StaEngine::add_internal_cell(RTLIL::Cell *cell)
+{
+	if (cell->type.in(ID($specify2), ID($specify3), ID($specrule)))
+		return;
+
+	int delay = estimate_delays ? estimate_delay(cell) : internal_delay;
+
+	if (RTLIL::builtin_ff_cell_types().count(cell->type) || cell->is_mem_cell())
+	{
+		// Sequential elements start and end paths; their inputs are
+		// captured by the clock, if they have one.
+		SigBit clock;
+		if (cell->hasPort(ID::CLK) && GetSize(cell->getPort(ID::CLK)) == 1)
+			clock = sigmap(cell->getPort(ID::CLK)[0]);
+		else if (cell->hasPort(ID::C))
+			clock = sigmap(cell->getPort(ID::C)[0]);
+
+		for (auto &conn : cell->connections()) {
+			if (conn.first.in(ID::CLK, ID::C))
+				continue;
+			for (auto bit : sigmap(conn.second)) {
+				if (!bit.wire)
+					continue;
+				if (cell->output(conn.first))
+					add_source(cell, bit);
+				else if (cell->input(conn.first))
+					add_endpoint(cell, bit, conn.first, 0, clock);
+			}
+		}
+		return;
+	}
+
+	StaEdgesDatabase db;
+	if (db.add_edges_from_cell(cell)) {
+		for (auto &edge : db.edges) {
+			SigBit src = sigmap(cell->getPort(std::get<0>(edge))[std::get<1>(edge)]);
+			SigBit dst = sigmap(cell->getPort(std::get<2>(edge))[std::get<3>(edge)]);
+			if (!src.wire || !dst.wire)
+				continue;
+			add_arc(cell, add_node(src), std::get<0>(edge), add_node(dst), std::get<2>(edge), delay);
+		}
+		return;
+	}
+
+	// Cells without a bit-level model: every input bit reaches every
+	// output bit, routed through one internal node per cell so that the
+	// number of arcs stays linear in the port widths.
+	int cell_node = -1;
+	for (auto &conn : cell->connections()) {
+		if (!cell->output(conn.first))
+			continue;
+		for (auto bit : sigmap(conn.second)) {
+			if (!bit.wire)
+				continue;
+			if (cell_node < 0) {
+				if (free_nodes.empty()) {
+					cell_node = new_node(SigBit());
+				} else {
+					cell_node = free_nodes.back();
+					free_nodes.pop_back();
+				}
+				cell_nodes[cell] = cell_node;
+			}
+			add_arc(cell, cell_node, IdString(), add_node(bit), conn.first, delay);
+		}
+	}
+	if (cell_node < 0)
+		return;
+	for (auto &conn : cell->connections()) {
+		if (!cell->input(conn.first))
+			continue;
+		for (auto bit : sigmap(conn.second))
+			if (bit.wire)
+				add_arc(cell, add_node(bit), conn.first, cell_node, IdString(), 0);
+	}
+}
+
+void StaEngine::add_cell(RTLIL::Cell *cell)
+{
+	RTLIL::Design *design = module->design;
+
+	if (cell->type.begins_with("$") && (internal_delay >= 0 || estimate_delays)) {
+		add_internal_cell(cell);
+		return;
+	}
+
+	Module *inst_module = design->module(cell->type);
+	if (!inst_module) {
+		if (unrecognised_cells.insert(cell->type).second)
+			log_warning("Cell type '%s' not recognised! Ignoring.\n", log_id(cell->type));
+		return;
+	}
+
+	if (!inst_module->get_blackbox_attribute()) {
+		if (unrecognised_cells.insert(cell->type).second)
+			log_warning("Cell type '%s' is not a black- nor white-box! Ignoring.\n", log_id(cell->type));
+		return;
+	}
+
+	IdString derived_type = cell->type;
+	if (!cell->parameters.empty()) {
+		derived_type = inst_module->derive(design, cell->parameters);
+		inst_module = design->module(derived_type);
+		log_assert(inst_module);
+	}
+
+	if (!timing.count(derived_type)) {
+		auto &t = timing.setup_module(inst_module);
+		if (t.has_inputs && t.comb.empty() && t.arrival.empty() && t.required.empty())
+			log_warning("Module '%s' has no timing arcs!\n", log_id(cell->type));
+	}
+
+	auto &t = timing.at(derived_type);
+	if (t.comb.empty() && t.arrival.empty() && t.required.empty())
+		return;
+
+	std::vector<std::pair<int, TimingInfo::NameBit>> src_bits, dst_bits;
+
+	for (auto &conn : cell->connections()) {
+		auto rhs = sigmap(conn.second);
+		for (auto i = 0; i < GetSize(rhs); i++) {
+			const auto &bit = rhs[i];
+			if (!bit.wire)
+				continue;
+			TimingInfo::NameBit namebit(conn.first, i);
+			if (cell->input(conn.first)) {
+				src_bits.emplace_back(add_node(bit), namebit);
+
+				auto it = t.required.find(namebit);
+				if (it == t.required.end())
+					continue;
+				const auto &c = it->second.second;
+				SigBit clock;
+				if (cell->hasPort(c.name))
+					clock = sigmap(cell->getPort(c.name)[c.offset]);
+				add_endpoint(cell, bit, conn.first, it->second.first, clock);
+			}
+			if (cell->output(conn.first)) {
+				int dst = add_node(bit);
+				dst_bits.emplace_back(dst, namebit);
+
+				auto it = t.arrival.find(namebit);
+				if (it == t.arrival.end())
+					continue;
+				const auto &s = it->second.second;
+				if (cell->hasPort(s.name)) {
+					auto s_bit = sigmap(cell->getPort(s.name)[s.offset]);
+					if (s_bit.wire)
+						add_arc(cell, add_node(s_bit), s.name, dst, conn.first, it->second.first);
+				}
+			}
+		}
+	}
+
+	for (const auto &s : src_bits)
+		for (const auto &d : dst_bits) {
+			auto it = t.comb.find(TimingInfo::BitBit(s.second, d.second));
+			if (it == t.comb.end())
+				continue;
+			add_arc(cell, s.first, s.second.name, d.first, d.second.name, it->second);
+		}
+}
+
+void StaEngine::setup()
+{
+	sigmap.set(module);
+	timing = TimingInfo();
+	unrecognised_cells.clear();
+
+	node_bits.clear();
+	bit_nodes.clear();
+	arrival.clear();
+	required.clear();
+	is_source.clear();
+	fanin_arcs.clear();
+	fanout_arcs.clear();
+	arcs.clear();
+	free_arcs.clear();
+	free_nodes.clear();
+	endpoints.clear();
+	cell_arcs.clear();
+	cell_nodes.clear();
+	cell_endpoints.clear();
+	cell_sources.clear();
+	worst_endpoint_arrival = -1;
+
+	for (auto cell : module->cells())
+		add_cell(cell);
+
+	for (auto port_name : module->ports) {
+		auto wire = module->wire(port_name);
+		if (wire->port_input)
+			for (auto bit : sigmap(wire))
+				if (bit.wire)
+					add_source(nullptr, bit);
+		if (wire->port_output)
+			for (auto bit : sigmap(wire))
+				if (bit.wire)
+					add_endpoint(nullptr, bit, IdString(), 0, SigBit());
+	}
+}
+
+void StaEngine::remove_cell(RTLIL::Cell *cell)
+{
+	auto arcs_it = cell_arcs.find(cell);
+	if (arcs_it != cell_arcs.end()) {
+		for (int a : arcs_it->second) {
+			Arc &arc = arcs[a];
+			auto &fo = fanout_arcs[arc.src];
+			fo.erase(std::find(fo.begin(), fo.end(), a));
+			auto &fi = fanin_arcs[arc.dst];
+			fi.erase(std::find(fi.begin(), fi.end(), a));
+			dirty_forward.insert(arc.dst);
+			dirty_backward.insert(arc.src);
+			arc.src = arc.dst = -1;
+			arc.cell = nullptr;
+			free_arcs.push_back(a);
+		}
+		cell_arcs.erase(arcs_it);
+	}
+
+	// All arcs of the internal node belonged to this cell, so it can be
+	// handed to the next cell that needs one.
+	auto node_it = cell_nodes.find(cell);
+	if (node_it != cell_nodes.end()) {
+		int n = node_it->second;
+		arrival[n] = -1;
+		required[n] = STA_UNCONSTRAINED;
+		dirty_forward.erase(n);
+		dirty_backward.erase(n);
+		free_nodes.push_back(n);
+		cell_nodes.erase(node_it);
+	}
+
+	auto ep_it = cell_endpoints.find(cell);
+	if (ep_it != cell_endpoints.end()) {
+		for (int n : ep_it->second) {
+			auto it = endpoints.find(n);
+			if (it == endpoints.end())
+				continue;
+			auto &eps = it->second;
+			eps.erase(std::remove_if(eps.begin(), eps.end(), [&](const Endpoint &ep) { return ep.sink == cell; }), eps.end());
+			if (eps.empty())
+				endpoints.erase(it);
+			dirty_backward.insert(n);
+		}
+		cell_endpoints.erase(ep_it);
+	}
+
+	auto src_it = cell_sources.find(cell);
+	if (src_it != cell_sources.end()) {
+		for (int n : src_it->second) {
+			is_source[n] = false;
+			dirty_forward.insert(n);
+		}
+		cell_sources.erase(src_it);
+	}
+}
+
+void StaEngine::update_cell(RTLIL::Cell *cell)
+{
+	remove_cell(cell);
+	add_cell(cell);
+}
+
+const StaEngine::Endpoint *StaEngine::endpoint_of(int n) const
+{
+	auto it = endpoints.find(n);
+	if (it == endpoints.end())
+		return nullptr;
+	const Endpoint *worst = nullptr;
+	for (auto &ep : it->second)
+		if (worst == nullptr || ep.setup > worst->setup)
+			worst = &ep;
+	return worst;
+}
+
+int StaEngine::endpoint_required(int n) const
+{
+	int req = STA_UNCONSTRAINED;
+	auto it = endpoints.find(n);
+	if (it == endpoints.end())
+		return req;
+	for (auto &ep : it->second) {
+		int period = default_period < 0 ? worst_endpoint_arrival : default_period;
+		auto cp = clock_period.find(ep.clock);
+		if (ep.clock.wire && cp != clock_period.end())
+			period = cp->second;
+		req = std::min(req, period - ep.setup);
+	}
+	return req;
+}
+
+// Pick the node at which to break a combinational loop once only untimed
+// nodes on or behind loops are left: walk from n against the direction of
+// propagation through untimed nodes until one repeats, then prefer a node of
+// that loop that is also reached from a timed node, i.e. the loop entry.
+static int loop_break_node(const StaEngine &sta, const dict<int, int> &pending, const pool<int> &done, int n, bool forward)
+{
+	auto is_timed = [&](int m) { return !pending.count(m) || done.count(m); };
+	auto untimed_pred = [&](int m) -> int {
+		for (int a : forward ? sta.fanin_arcs[m] : sta.fanout_arcs[m]) {
+			int p = forward ? sta.arcs[a].src : sta.arcs[a].dst;
+			if (!is_timed(p))
+				return p;
+		}
+		log_abort();
+	};
+	auto has_timed_pred = [&](int m) -> bool {
+		for (int a : forward ? sta.fanin_arcs[m] : sta.fanout_arcs[m])
+			if (is_timed(forward ? sta.arcs[a].src : sta.arcs[a].dst))
+				return true;
+		return false;
+	};
+
+	pool<int> visited;
+	while (visited.insert(n).second)
+		n = untimed_pred(n);
+	int m = n;
+	do {
+		if (has_timed_pred(m))
+			return m;
+		m = untimed_pred(m);
+	} while (m != n);
+	return n;
+}
+
+void StaEngine::propagate_forward(const pool<int> &seeds)
+{
+	// Levelize the fan-out cone of the seeds and recompute arrival times in
+	// topological order. When only nodes on or behind a combinational loop
+	// are left, the loop is broken by ignoring the arcs into one of its nodes
+	// from nodes that have not been timed yet.
+	std::vector<int> cone, queue;
+	dict<int, int> pending;
+	pool<int> done;
+	for (int n : seeds)
+		if (pending.insert(std::make_pair(n, 0)).second)
+			cone.push_back(n);
+	for (int i = 0; i < GetSize(cone); i++)
+		for (int a : fanout_arcs[cone[i]])
+			if (pending.insert(std::make_pair(arcs[a].dst, 0)).second)
+				cone.push_back(arcs[a].dst);
+
+	for (int n : cone)
+		for (int a : fanin_arcs[n])
+			if (pending.count(arcs[a].src))
+				pending[n]++;
+	for (int n : cone)
+		if (pending.at(n) == 0)
+			queue.push_back(n);
+
+	int next_undone = 0;
+	for (int i = 0; i < GetSize(cone); i++) {
+		if (i == GetSize(queue)) {
+			while (done.count(cone[next_undone]))
+				next_undone++;
+			int n = loop_break_node(*this, pending, done, cone[next_undone], true);
+			if (!warned_loop)
+				log_warning("Combinational loop through %s in module %s, ignoring loop for timing.\n",
+						node_bits[n].wire ? log_signal(node_bits[n]) : log_id(arcs[fanout_arcs[n].front()].cell),
+						log_id(module));
+			warned_loop = true;
+			pending.at(n) = -1;
+			queue.push_back(n);
+		}
+
+		int n = queue[i];
+		done.insert(n);
+		int arr = is_source[n] ? 0 : -1;
+		for (int a : fanin_arcs[n]) {
+			const Arc &arc = arcs[a];
+			if (pending.count(arc.src) && !done.count(arc.src))
+				continue;
+			if (arrival[arc.src] >= 0)
+				arr = std::max(arr, arrival[arc.src] + arc.delay);
+		}
+		arrival[n] = arr;
+		for (int a : fanout_arcs[n])
+			if (--pending.at(arcs[a].dst) == 0)
+				queue.push_back(arcs[a].dst);
+	}
+}
+
+void StaEngine::propagate_backward(const pool<int> &seeds)
+{
+	// As propagate_forward(), but over the fan-in cone of the seeds.
+	std::vector<int> cone, queue;
+	dict<int, int> pending;
+	pool<int> done;
+	for (int n : seeds)
+		if (pending.insert(std::make_pair(n, 0)).second)
+			cone.push_back(n);
+	for (int i = 0; i < GetSize(cone); i++)
+		for (int a : fanin_arcs[cone[i]])
+			if (pending.insert(std::make_pair(arcs[a].src, 0)).second)
+				cone.push_back(arcs[a].src);
+
+	for (int n : cone)
+		for (int a : fanout_arcs[n])
+			if (pending.count(arcs[a].dst))
+				pending[n]++;
+	for (int n : cone)
+		if (pending.at(n) == 0)
+			queue.push_back(n);
+
+	int next_undone = 0;
+	for (int i = 0; i < GetSize(cone); i++) {
+		if (i == GetSize(queue)) {
+			while (done.count(cone[next_undone]))
+				next_undone++;
+			int n = loop_break_node(*this, pending, done, cone[next_undone], false);
+			pending.at(n) = -1;
+			queue.push_back(n);
+		}
+
+		int n = queue[i];
+		done.insert(n);
+		int req = endpoint_required(n);
+		for (int a : fanout_arcs[n]) {
+			const Arc &arc = arcs[a];
+			if (pending.count(arc.dst) && !done.count(arc.dst))
+				continue;
+			if (required[arc.dst] != STA_UNCONSTRAINED)
+				req = std::min(req, required[arc.dst] - arc.delay);
+		}
+		required[n] = req;
+		for (int a : fanin_arcs[n])
+			if (--pending.at(arcs[a].src) == 0)
+				queue.push_back(arcs[a].src);
+	}
+}
+
+static int worst_arrival_of(const StaEngine &sta)
+{
+	int worst = -1;
+	for (auto &it : sta.endpoints) {
+		int arr = sta.arrival[it.first];
+		if (arr < 0)
+			continue;
+		for (auto &ep : it.second)
+			worst = std::max(worst, arr + ep.setup);
+	}
+	return worst;
+}
+
+void StaEngine::run()
+{
+	pool<int> all;
+	for (int n = 0; n < GetSize(node_bits); n++)
+		all.insert(n);
+
+	propagate_forward(all);
+	worst_endpoint_arrival = worst_arrival_of(*this);
+	propagate_backward(all);
+
+	dirty_forward.clear();
+	dirty_backward.clear();
+}
+
+void StaEngine::update()
+{
+	propagate_forward(dirty_forward);
+
+	int old_worst = worst_endpoint_arrival;
+	worst_endpoint_arrival = worst_arrival_of(*this);
+
+	if (default_period < 0 && worst_endpoint_arrival != old_worst) {
+		// All default required times follow the worst arrival.
+		pool<int> all;
+		for (int n = 0; n < GetSize(node_bits); n++)
+			all.insert(n);
+		propagate_backward(all);
+	} else {
+		// Arrival changes do not affect required times, but edited arcs
+		// and endpoints do.
+		propagate_backward(dirty_backward);
+	}
+
+	dirty_forward.clear();
+	dirty_backward.clear();
+}
+
+std::vector<int> StaEngine::backtrack(int n) const
+{
+	// Zero-delay arcs around a broken loop can match as well; never visit a
+	// node twice.
+	std::vector<int> path;
+	pool<int> visited;
+	while (n >= 0 && arrival[n] >= 0) {
+		visited.insert(n);
+		int next = -1;
+		for (int a : fanin_arcs[n]) {
+			const Arc &arc = arcs[a];
+			if (arrival[arc.src] >= 0 && arrival[arc.src] + arc.delay == arrival[n] && !visited.count(arc.src)) {
+				path.push_back(a);
+				next = arc.src;
+				break;
+			}
+		}
+		n = next;
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+std::vector<StaEngine::Path> StaEngine::worst_paths(int count) const
+{
+	std::vector<Path> paths;
+	for (auto &it : endpoints) {
+		int n = it.first;
+		if (arrival[n] < 0)
+			continue;
+		Path p;
+		p.node = n;
+		p.endpoint = *endpoint_of(n);
+		p.arrival = arrival[n] + p.endpoint.setup;
+		p.required = endpoint_required(n) + p.endpoint.setup;
+		paths.push_back(p);
+	}
+
+	std::sort(paths.begin(), paths.end(), [](const Path &a, const Path &b) {
+		int a_slack = a.required - a.arrival, b_slack = b.required - b.arrival;
+		if (a_slack != b_slack)
+			return a_slack < b_slack;
+		if (a.arrival != b.arrival)
+			return a.arrival > b.arrival;
+		return a.node < b.node;
+	});
+
+	if (GetSize(paths) > count)
+		paths.resize(count);
+	for (auto &p : paths)
+		p.arcs = backtrack(p.node);
+	return paths;
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,144 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef STA_H
+#define STA_H
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/timinginfo.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+struct Macc;
+
+// Static timing analysis of a single (flattened) module.
+//
+// Timing arcs come from the specify blocks of black-box cells (see
+// TimingInfo) and, if internal_delay is non-negative or estimate_delays is
+// set, from built-in cells. Every net bit is a node; arrival and required
+// times are kept in flat arrays indexed by node id. After setup() and
+// run(), cells may be added, changed or removed and the timing brought up to
+// date with update_cell()/remove_cell() followed by update(), which only
+// revisits the fan-in and fan-out cones of the edited cells. Edits must not
+// change module->connections(); call setup() again in that case.
+struct StaEngine
+{
+	struct Arc {
+		int src, dst;
+		int delay;
+		RTLIL::Cell *cell;
+		RTLIL::IdString src_port, dst_port;
+	};
+
+	struct Endpoint {
+		RTLIL::Cell *sink;
+		RTLIL::IdString port;
+		int setup;
+		RTLIL::SigBit clock;
+	};
+
+	struct Path {
+		int node;
+		int arrival, required;
+		Endpoint endpoint;
+		std::vector<int> arcs;
+	};
+
+	RTLIL::Module *module;
+	SigMap sigmap;
+	TimingInfo timing;
+
+	// Delay of a combinational arc through a built-in cell, or -1 to ignore
+	// built-in cells altogether (as black-box-only timing analysis does)
+	int internal_delay = -1;
+
+	// Use estimate_delay() for built-in cells instead of internal_delay
+	bool estimate_delays = false;
+
+	// Required time at endpoints captured by the given (sigmapped) clock
+	// bit, and at all other endpoints. A negative default_period uses the
+	// latest endpoint arrival, so that the critical path has zero slack.
+	dict<RTLIL::SigBit, int> clock_period;
+	int default_period = -1;
+
+	std::vector<RTLIL::SigBit> node_bits;
+	dict<RTLIL::SigBit, int> bit_nodes;
+	std::vector<int> arrival, required;
+	std::vector<bool> is_source;
+	std::vector<std::vector<int>> fanin_arcs, fanout_arcs;
+	std::vector<Arc> arcs;
+	std::vector<int> free_arcs, free_nodes;
+	dict<int, std::vector<Endpoint>> endpoints;
+
+	dict<RTLIL::Cell*, std::vector<int>> cell_arcs, cell_endpoints, cell_sources;
+	dict<RTLIL::Cell*, int> cell_nodes;
+	pool<int> dirty_forward, dirty_backward;
+	pool<RTLIL::IdString> unrecognised_cells;
+	int worst_endpoint_arrival = -1;
+	bool warned_loop = false;
+
+	StaEngine(RTLIL::Module *module) : module(module) { }
+
+	void setup();
+	void run();
+
+	void update_cell(RTLIL::Cell *cell);
+	void remove_cell(RTLIL::Cell *cell);
+	void update();
+
+	int node(RTLIL::SigBit bit) const;
+	int arrival_of(RTLIL::SigBit bit) const;
+	int required_of(RTLIL::SigBit bit) const;
+	int slack_of(RTLIL::SigBit bit) const;
+
+	// Latest arrival over all endpoints, including their setup times
+	int worst_arrival() const { return worst_endpoint_arrival; }
+
+	// The endpoint with the largest setup time at a node, or nullptr
+	const Endpoint *endpoint_of(int node) const;
+
+	// The given number of worst paths, one per endpoint node, ordered by
+	// slack and then by arrival
+	std::vector<Path> worst_paths(int count) const;
+
+	// The arcs of the latest-arriving path into a node, first arc first
+	std::vector<int> backtrack(int node) const;
+
+	// Rough delay of a built-in cell in the units of
+	// CellCosts::default_gate_cost(), assuming logarithmic-depth
+	// implementations of wide operators
+	static int estimate_delay(RTLIL::Cell *cell);
+	static int estimate_macc_delay(const Macc &macc, int width);
+
+	int new_node(RTLIL::SigBit bit);
+	int add_node(RTLIL::SigBit bit);
+	void add_arc(RTLIL::Cell *cell, int src, RTLIL::IdString src_port, int dst, RTLIL::IdString dst_port, int delay);
+	void add_endpoint(RTLIL::Cell *cell, RTLIL::SigBit bit, RTLIL::IdString port, int setup, RTLIL::SigBit clock);
+	void add_source(RTLIL::Cell *cell, RTLIL::SigBit bit);
+	void add_cell(RTLIL::Cell *cell);
+	void add_internal_cell(RTLIL::Cell *cell);
+	int endpoint_required(int node) const;
+	void propagate_forward(const pool<int> &seeds);
+	void propagate_backward(const pool<int> &seeds);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -21,10 +21,294 @@
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
 #include "kernel/utils.h"
+#include "kernel/graph.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// Checks a single module. Net bits and logic cells are numbered as nodes of
+// an IntGraph and drivers are only counted per node. The descriptions of
+// drivers and logic loops are only built for modules that have such problems.
+struct CheckWorker
+{
+	RTLIL::Module *module;
+	SigMap sigmap;
+	bool noinit = false, initdrv = false, mapped = false, allow_tbuf = false;
+	int counter = 0;
+
+	IntGraph graph;
+	dict<SigBit, int> bit_nodes;
+	std::vector<SigBit> node_bits;
+	std::vector<int> driver_count;
+	std::vector<bool> driven, used;
+	std::vector<int> driven_order, used_order;
+	pool<SigBit> init_bits;
+
+	// set while scan_module() only collects the driver descriptions of the
+	// bits in driver_messages
+	bool collect_drivers = false;
+	dict<int, std::vector<std::string>> driver_messages;
+
+	CheckWorker(RTLIL::Module *module) : module(module), sigmap(module) { }
+
+	int new_node(SigBit bit = SigBit())
+	{
+		node_bits.push_back(bit);
+		driver_count.push_back(0);
+		driven.push_back(false);
+		used.push_back(false);
+		return graph.add_node();
+	}
+
+	// bit must already be mapped by sigmap
+	int bit_node(const SigBit &bit)
+	{
+		auto it = bit_nodes.find(bit);
+		if (it != bit_nodes.end())
+			return it->second;
+		int node = new_node(bit);
+		bit_nodes[bit] = node;
+		return node;
+	}
+
+	void use_node(int node)
+	{
+		if (!used[node]) {
+			used[node] = true;
+			used_order.push_back(node);
+		}
+	}
+
+	void use(const SigSpec &sig)
+	{
+		if (collect_drivers)
+			return;
+		for (auto bit : sigmap(sig))
+			if (bit.wire)
+				use_node(bit_node(bit));
+	}
+
+	template<typename F>
+	int add_driver(const SigBit &bit, bool counted, F describe)
+	{
+		int node = bit_node(bit);
+		if (collect_drivers) {
+			auto it = driver_messages.find(node);
+			if (it != driver_messages.end())
+				it->second.push_back(describe());
+			return node;
+		}
+		if (!driven[node]) {
+			driven[node] = true;
+			driven_order.push_back(node);
+		}
+		if (counted)
+			driver_count[node]++;
+		return node;
+	}
+
+	// Visits the drivers of all net bits in the order in which they are
+	// listed in warnings. Unless collect_drivers is set, this also records
+	// the used bits and the logic graph and runs the per-object checks.
+	void scan_module()
+	{
+		for (auto &proc_it : module->processes)
+		{
+			std::vector<RTLIL::CaseRule*> all_cases = {&proc_it.second->root_case};
+			for (size_t i = 0; i < all_cases.size(); i++) {
+				for (auto &action : all_cases[i]->actions) {
+					for (auto bit : sigmap(action.first))
+						if (bit.wire)
+							add_driver(bit, false, [&]() {
+								return stringf("action %s <= %s (case rule) in process %s",
+										log_signal(action.first), log_signal(action.second), log_id(proc_it.first));
+							});
+					use(action.second);
+				}
+				for (auto switch_ : all_cases[i]->switches) {
+					for (auto case_ : switch_->cases) {
+						all_cases.push_back(case_);
+						for (auto &compare : case_->compare)
+							use(compare);
+					}
+				}
+			}
+			for (auto &sync : proc_it.second->syncs) {
+				use(sync->signal);
+				for (auto &action : sync->actions) {
+					for (auto bit : sigmap(action.first))
+						if (bit.wire)
+							add_driver(bit, false, [&]() {
+								return stringf("action %s <= %s (sync rule) in process %s",
+										log_signal(action.first), log_signal(action.second), log_id(proc_it.first));
+							});
+					use(action.second);
+				}
+				for (auto &memwr : sync->mem_write_actions) {
+					use(memwr.address);
+					use(memwr.data);
+					use(memwr.enable);
+				}
+			}
+		}
+
+		for (auto cell : module->cells())
+		{
+			if (mapped && !collect_drivers && cell->type.begins_with("$") && module->design->module(cell->type) == nullptr) {
+				if (allow_tbuf && cell->type == ID($_TBUF_)) goto cell_allowed;
+				log_warning("Cell %s.%s is an unmapped internal cell of type %s.\n", log_id(module), log_id(cell), log_id(cell->type));
+				counter++;
+			cell_allowed:;
+			}
+			bool logic_cell = !collect_drivers && yosys_celltypes.cell_evaluable(cell->type);
+			int cell_node = logic_cell ? new_node() : -1;
+			for (auto &conn : cell->connections()) {
+				bool is_input = cell->input(conn.first);
+				bool is_output = cell->output(conn.first);
+				if (!is_input && !is_output)
+					continue;
+				SigSpec sig = sigmap(conn.second);
+				if (is_input && !collect_drivers)
+					for (auto bit : sig)
+						if (bit.wire) {
+							int node = bit_node(bit);
+							if (logic_cell)
+								graph.add_edge(node, cell_node);
+							use_node(node);
+						}
+				if (is_output)
+					for (int i = 0; i < GetSize(sig); i++)
+						if (sig[i].wire) {
+							int node = add_driver(sig[i], !is_input, [&]() {
+								return stringf("port %s[%d] of cell %s (%s)",
+										log_id(conn.first), i, log_id(cell), log_id(cell->type));
+							});
+							if (logic_cell)
+								graph.add_edge(cell_node, node);
+						}
+			}
+		}
+
+		for (auto wire : module->wires()) {
+			if (wire->port_input) {
+				SigSpec sig = sigmap(wire);
+				for (int i = 0; i < GetSize(sig); i++)
+					if (sig[i].wire)
+						add_driver(sig[i], !wire->port_output, [&]() {
+							return stringf("module input %s[%d]", log_id(wire), i);
+						});
+			}
+			if (collect_drivers)
+				continue;
+			if (wire->port_output)
+				use(wire);
+			if (wire->attributes.count(ID::init)) {
+				Const initval = wire->attributes.at(ID::init);
+				for (int i = 0; i < GetSize(initval) && i < GetSize(wire); i++)
+					if (initval[i] == State::S0 || initval[i] == State::S1)
+						init_bits.insert(sigmap(SigBit(wire, i)));
+				if (noinit) {
+					log_warning("Wire %s.%s has an unprocessed 'init' attribute.\n", log_id(module), log_id(wire));
+					counter++;
+				}
+			}
+		}
+	}
+
+	// Reports the same loops, in the same order, as sorting the netlist with
+	// a TopoSort on descriptive node names
+	void report_loops()
+	{
+		TopoSort<string> topo;
+
+		for (auto cell : module->cells())
+		{
+			if (!yosys_celltypes.cell_evaluable(cell->type))
+				continue;
+			for (auto &conn : cell->connections()) {
+				SigSpec sig = sigmap(conn.second);
+				if (cell->input(conn.first))
+					for (auto bit : sig)
+						if (bit.wire)
+							topo.edge(stringf("wire %s", log_signal(bit)),
+									stringf("cell %s (%s)", log_id(cell), log_id(cell->type)));
+				if (cell->output(conn.first))
+					for (int i = 0; i < GetSize(sig); i++)
+						topo.edge(stringf("cell %s (%s)", log_id(cell), log_id(cell->type)),
+								stringf("wire %s", log_signal(sig[i])));
+			}
+		}
+
+		topo.sort();
+		for (auto &loop : topo.loops) {
+			string message = stringf("found logic loop in module %s:\n", log_id(module));
+			for (auto &str : loop)
+				message += stringf("    %s\n", str.c_str());
+			log_warning("%s", message.c_str());
+			counter++;
+		}
+	}
+
+	void run()
+	{
+		scan_module();
+
+		// warnings are listed in the (reverse insertion) order of the dict
+		// and pool that were used to collect drivers and used bits before
+		for (int node : driven_order)
+			if (driver_count[node] > 1)
+				driver_messages[node];
+
+		if (!driver_messages.empty()) {
+			collect_drivers = true;
+			scan_module();
+			collect_drivers = false;
+
+			for (int i = GetSize(driven_order)-1; i >= 0; i--) {
+				auto it = driver_messages.find(driven_order[i]);
+				if (it == driver_messages.end())
+					continue;
+				string message = stringf("multiple conflicting drivers for %s.%s:\n", log_id(module), log_signal(node_bits[it->first]));
+				for (auto &str : it->second)
+					message += stringf("    %s\n", str.c_str());
+				log_warning("%s", message.c_str());
+				counter++;
+			}
+		}
+
+		for (int i = GetSize(used_order)-1; i >= 0; i--)
+			if (!driven[used_order[i]]) {
+				log_warning("Wire %s.%s is used but has no driver.\n", log_id(module), log_signal(node_bits[used_order[i]]));
+				counter++;
+			}
+
+		graph.build();
+		std::vector<int> order;
+		if (!graph.topo_order(order))
+			report_loops();
+
+		if (initdrv)
+		{
+			for (auto cell : module->cells())
+			{
+				if (RTLIL::builtin_ff_cell_types().count(cell->type) == 0)
+					continue;
+
+				for (auto bit : sigmap(cell->getPort(ID::Q)))
+					init_bits.erase(bit);
+			}
+
+			SigSpec init_sig(init_bits);
+			init_sig.sort_and_unify();
+
+			for (auto chunk : init_sig.chunks()) {
+				log_warning("Wire %s.%s has 'init' attribute and is not driven by an FF cell.\n", log_id(module), log_signal(chunk));
+				counter++;
+			}
+		}
+	}
+};
+
 struct CheckPass : public Pass {
 	CheckPass() : Pass("check", "check for obvious problems in the design") { }
 	void help() override
@@ -100,161 +384,14 @@ struct CheckPass : public Pass {
 		{
 			log("Checking module %s...\n", log_id(module));
 
-			SigMap sigmap(module);
-			dict<SigBit, vector<string>> wire_drivers;
-			dict<SigBit, int> wire_drivers_count;
-			pool<SigBit> used_wires;
-			TopoSort<string> topo;
+			CheckWorker worker(module);
+			worker.noinit = noinit;
+			worker.mapped = mapped;
+			worker.initdrv = initdrv;
+			worker.allow_tbuf = allow_tbuf;
+			worker.run();
 
-			for (auto &proc_it : module->processes)
-			{
-				std::vector<RTLIL::CaseRule*> all_cases = {&proc_it.second->root_case};
-				for (size_t i = 0; i < all_cases.size(); i++) {
-					for (auto action : all_cases[i]->actions) {
-						for (auto bit : sigmap(action.first))
-							if (bit.wire) {
-								wire_drivers[bit].push_back(
-									stringf("action %s <= %s (case rule) in process %s",
-									        log_signal(action.first), log_signal(action.second), log_id(proc_it.first)));
-							}
-						for (auto bit : sigmap(action.second))
-							if (bit.wire) used_wires.insert(bit);
-					}
-					for (auto switch_ : all_cases[i]->switches) {
-						for (auto case_ : switch_->cases) {
-							all_cases.push_back(case_);
-							for (auto compare : case_->compare)
-								for (auto bit : sigmap(compare))
-									if (bit.wire) used_wires.insert(bit);
-						}
-					}
-				}
-				for (auto &sync : proc_it.second->syncs) {
-					for (auto bit : sigmap(sync->signal))
-						if (bit.wire) used_wires.insert(bit);
-					for (auto action : sync->actions) {
-						for (auto bit : sigmap(action.first))
-							if (bit.wire)
-								wire_drivers[bit].push_back(
-									stringf("action %s <= %s (sync rule) in process %s",
-									        log_signal(action.first), log_signal(action.second), log_id(proc_it.first)));
-						for (auto bit : sigmap(action.second))
-							if (bit.wire) used_wires.insert(bit);
-					}
-					for (auto memwr : sync->mem_write_actions) {
-						for (auto bit : sigmap(memwr.address))
-							if (bit.wire) used_wires.insert(bit);
-						for (auto bit : sigmap(memwr.data))
-							if (bit.wire) used_wires.insert(bit);
-						for (auto bit : sigmap(memwr.enable))
-							if (bit.wire) used_wires.insert(bit);
-					}
-				}
-			}
-
-			for (auto cell : module->cells())
-			{
-				if (mapped && cell->type.begins_with("$") && design->module(cell->type) == nullptr) {
-					if (allow_tbuf && cell->type == ID($_TBUF_)) goto cell_allowed;
-					log_warning("Cell %s.%s is an unmapped internal cell of type %s.\n", log_id(module), log_id(cell), log_id(cell->type));
-					counter++;
-				cell_allowed:;
-				}
-				for (auto &conn : cell->connections()) {
-					SigSpec sig = sigmap(conn.second);
-					bool logic_cell = yosys_celltypes.cell_evaluable(cell->type);
-					if (cell->input(conn.first))
-						for (auto bit : sig)
-							if (bit.wire) {
-								if (logic_cell)
-									topo.edge(stringf("wire %s", log_signal(bit)),
-											stringf("cell %s (%s)", log_id(cell), log_id(cell->type)));
-								used_wires.insert(bit);
-							}
-					if (cell->output(conn.first))
-						for (int i = 0; i < GetSize(sig); i++) {
-							if (logic_cell)
-								topo.edge(stringf("cell %s (%s)", log_id(cell), log_id(cell->type)),
-										stringf("wire %s", log_signal(sig[i])));
-							if (sig[i].wire)
-								wire_drivers[sig[i]].push_back(stringf("port %s[%d] of cell %s (%s)",
-										log_id(conn.first), i, log_id(cell), log_id(cell->type)));
-						}
-					if (!cell->input(conn.first) && cell->output(conn.first))
-						for (auto bit : sig)
-							if (bit.wire) wire_drivers_count[bit]++;
-				}
-			}
-
-			pool<SigBit> init_bits;
-
-			for (auto wire : module->wires()) {
-				if (wire->port_input) {
-					SigSpec sig = sigmap(wire);
-					for (int i = 0; i < GetSize(sig); i++)
-						wire_drivers[sig[i]].push_back(stringf("module input %s[%d]", log_id(wire), i));
-				}
-				if (wire->port_output)
-					for (auto bit : sigmap(wire))
-						if (bit.wire) used_wires.insert(bit);
-				if (wire->port_input && !wire->port_output)
-					for (auto bit : sigmap(wire))
-						if (bit.wire) wire_drivers_count[bit]++;
-				if (wire->attributes.count(ID::init)) {
-					Const initval = wire->attributes.at(ID::init);
-					for (int i = 0; i < GetSize(initval) && i < GetSize(wire); i++)
-						if (initval[i] == State::S0 || initval[i] == State::S1)
-							init_bits.insert(sigmap(SigBit(wire, i)));
-					if (noinit) {
-						log_warning("Wire %s.%s has an unprocessed 'init' attribute.\n", log_id(module), log_id(wire));
-						counter++;
-					}
-				}
-			}
-
-			for (auto it : wire_drivers)
-				if (wire_drivers_count[it.first] > 1) {
-					string message = stringf("multiple conflicting drivers for %s.%s:\n", log_id(module), log_signal(it.first));
-					for (auto str : it.second)
-						message += stringf("    %s\n", str.c_str());
-					log_warning("%s", message.c_str());
-					counter++;
-				}
-
-			for (auto bit : used_wires)
-				if (!wire_drivers.count(bit)) {
-					log_warning("Wire %s.%s is used but has no driver.\n", log_id(module), log_signal(bit));
-					counter++;
-				}
-
-			topo.sort();
-			for (auto &loop : topo.loops) {
-				string message = stringf("found logic loop in module %s:\n", log_id(module));
-				for (auto &str : loop)
-					message += stringf("    %s\n", str.c_str());
-				log_warning("%s", message.c_str());
-				counter++;
-			}
-
-			if (initdrv)
-			{
-				for (auto cell : module->cells())
-				{
-					if (RTLIL::builtin_ff_cell_types().count(cell->type) == 0)
-						continue;
-
-					for (auto bit : sigmap(cell->getPort(ID::Q)))
-						init_bits.erase(bit);
-				}
-
-				SigSpec init_sig(init_bits);
-				init_sig.sort_and_unify();
-
-				for (auto chunk : init_sig.chunks()) {
-					log_warning("Wire %s.%s has 'init' attribute and is not driven by an FF cell.\n", log_id(module), log_signal(chunk));
-					counter++;
-				}
-			}
+			counter += worker.counter;
 		}
 
 		log("Found and reported %d problems.\n", counter);
@@ -20,6 +20,9 @@
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
+#include "kernel/graph.h"
+#include "kernel/cost.h"
+#include "kernel/sta.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -29,16 +32,28 @@ struct LtpWorker
 	RTLIL::Design *design;
 	RTLIL::Module *module;
 	SigMap sigmap;
-
-	dict<SigBit, tuple<int, SigBit, Cell*>> bits;
-	dict<SigBit, dict<SigBit, Cell*>> bit2bits;
+	bool cost_mode;
+
+	// One node per (sigmapped) bit of a selected wire, and one node per
+	// selected cell. Edges lead from the input bits of a cell to its node,
+	// and from there to its output bits, so that a cell with many inputs and
+	// outputs does not need an edge for every pair of them.
+	IntGraph graph;
+	std::vector<SigBit> node_bits;
+	std::vector<Cell*> node_cells;
+	dict<SigBit, int> bit_nodes;
 	dict<SigBit, tuple<SigBit, Cell*>> bit2ff;
 
-	int maxlvl;
-	SigBit maxbit;
-	pool<SigBit> busy;
+	CellCosts costs;
+	dict<IdString, int> type_costs;
+
+	// Longest path into every node: its cost (in cells, or in the units of
+	// CellCosts with -cost), its length in cells, and where it came from
+	std::vector<int> cost, length, from;
+	std::vector<Cell*> via;
 
-	LtpWorker(RTLIL::Module *module, bool noff) : design(module->design), module(module), sigmap(module)
+	LtpWorker(RTLIL::Module *module, bool noff, bool cost_mode) :
+			design(module->design), module(module), sigmap(module), cost_mode(cost_mode)
 	{
 		CellTypes ff_celltypes;
 
@@ -47,9 +62,16 @@ struct LtpWorker
 			ff_celltypes.setup_stdcells_mem();
 		}
 
+		costs.design = design;
+		costs.gate_cost = &CellCosts::default_gate_cost();
+
 		for (auto wire : module->selected_wires())
 			for (auto bit : sigmap(wire))
-				bits[bit] = tuple<int, SigBit, Cell*>(-1, State::Sx, nullptr);
+				if (!bit_nodes.count(bit)) {
+					bit_nodes[bit] = graph.add_node();
+					node_bits.push_back(bit);
+					node_cells.push_back(nullptr);
+				}
 
 		for (auto cell : module->selected_cells())
 		{
@@ -72,70 +94,159 @@ struct LtpWorker
 				continue;
 			}
 
-			for (auto s : src_bits)
-				for (auto d : dst_bits)
-					bit2bits[s][d] = cell;
+			int cell_node = graph.add_node();
+			node_bits.push_back(State::Sx);
+			node_cells.push_back(cell);
+
+			for (auto s : src_bits) {
+				auto it = bit_nodes.find(s);
+				if (it != bit_nodes.end())
+					graph.add_edge(it->second, cell_node);
+			}
+
+			for (auto d : dst_bits) {
+				auto it = bit_nodes.find(d);
+				if (it != bit_nodes.end())
+					graph.add_edge(cell_node, it->second);
+			}
 		}
 
-		maxlvl = -1;
-		maxbit = State::Sx;
+		graph.build();
 	}
 
-	void runner(SigBit bit, int level, SigBit from, Cell *via)
+	int cell_cost(Cell *cell)
 	{
-		auto &bitinfo = bits.at(bit);
+		if (!cost_mode)
+			return 1;
 
-		if (get<0>(bitinfo) >= level)
-			return;
+		if (cell->type.begins_with("$"))
+			return StaEngine::estimate_delay(cell);
 
-		if (busy.count(bit) > 0) {
-			log_warning("Detected loop at %s in %s\n", log_signal(bit), log_id(module));
-			return;
-		}
-
-		busy.insert(bit);
-		get<0>(bitinfo) = level;
-		get<1>(bitinfo) = from;
-		get<2>(bitinfo) = via;
-
-		if (level > maxlvl) {
-			maxlvl = level;
-			maxbit = bit;
-		}
+		if (design->module(cell->type) != nullptr && cell->parameters.empty())
+			return costs.get(cell);
 
-		if (bit2bits.count(bit)) {
-			for (auto &it : bit2bits.at(bit))
-				runner(it.first, level+1, bit, it.second);
+		if (!type_costs.count(cell->type)) {
+			log_warning("Can't determine cost of %s cell, using 1.\n", log_id(cell->type));
+			type_costs[cell->type] = 1;
 		}
-
-		busy.erase(bit);
+		return type_costs.at(cell->type);
 	}
 
-	void printpath(SigBit bit)
+	void printpath(int node)
 	{
-		auto &bitinfo = bits.at(bit);
-		if (get<2>(bitinfo)) {
-			printpath(get<1>(bitinfo));
-			log("%5d: %s (via %s)\n", get<0>(bitinfo), log_signal(bit), log_id(get<2>(bitinfo)));
-		} else {
-			log("%5d: %s\n", get<0>(bitinfo), log_signal(bit));
+		std::vector<int> path;
+		for (; node >= 0; node = from[node])
+			if (node_cells[node] == nullptr)
+				path.push_back(node);
+
+		for (auto it = path.rbegin(); it != path.rend(); ++it) {
+			string prefix = stringf("%5d", length[*it]);
+			if (cost_mode)
+				prefix += stringf(" %6d", cost[*it]);
+			if (via[*it])
+				log("%s: %s (via %s)\n", prefix.c_str(), log_signal(node_bits[*it]), log_id(via[*it]));
+			else
+				log("%s: %s\n", prefix.c_str(), log_signal(node_bits[*it]));
+		}
+
+		SigBit bit = node_bits[path.front()];
+		if (bit2ff.count(bit)) {
+			auto &ff = bit2ff.at(bit);
+			log("%5s: %s (via %s)\n", "ff", log_signal(get<0>(ff)), log_id(get<1>(ff)));
 		}
 	}
 
-	void run()
+	void run(int num_paths)
 	{
-		for (auto &it : bits)
-			if (get<0>(it.second) < 0)
-				runner(it.first, 0, State::Sx, nullptr);
+		int num_nodes = graph.num_nodes;
+
+		// Loops are broken up at the edges that close them in a depth-first
+		// search, so that the remaining graph can be levelized
+		std::vector<bool> back = graph.back_edges();
+		pool<int> loop_nodes;
+
+		IntGraph dag(num_nodes);
+		for (int n = 0; n < num_nodes; n++)
+			for (int k = graph.first[n]; k < graph.first[n+1]; k++) {
+				int s = graph.succ[k];
+				if (!back[k])
+					dag.add_edge(n, s);
+				else if (loop_nodes.insert(s).second) {
+					if (node_cells[s])
+						log_warning("Detected loop at cell %s in %s\n", log_id(node_cells[s]), log_id(module));
+					else
+						log_warning("Detected loop at %s in %s\n", log_signal(node_bits[s]), log_id(module));
+				}
+			}
+		dag.build();
+
+		std::vector<int> order;
+		bool acyclic = dag.topo_order(order);
+		log_assert(acyclic);
+
+		// Entering the node of a cell adds the cell to the path
+		std::vector<int> node_cost(num_nodes);
+		for (int n = 0; n < num_nodes; n++)
+			if (node_cells[n])
+				node_cost[n] = cell_cost(node_cells[n]);
+
+		cost.assign(num_nodes, 0);
+		length.assign(num_nodes, 0);
+		from.assign(num_nodes, -1);
+		via.assign(num_nodes, nullptr);
+
+		for (int n : order)
+			for (int k = dag.first[n]; k < dag.first[n+1]; k++) {
+				int s = dag.succ[k];
+				int s_cost = cost[n] + node_cost[s];
+				int s_length = length[n] + (node_cells[s] ? 1 : 0);
+				if (from[s] < 0 || s_cost > cost[s] || (s_cost == cost[s] && s_length > length[s])) {
+					cost[s] = s_cost;
+					length[s] = s_length;
+					from[s] = n;
+					via[s] = node_cells[s] ? node_cells[s] : via[n];
+				}
+			}
 
-		log("\n");
-		log("Longest topological path in %s (length=%d):\n", log_id(module), maxlvl);
+		// Report the longest paths, skipping ends that are on the path of a
+		// longer one reported before
+		std::vector<int> ends;
+		for (int n = 0; n < num_nodes; n++)
+			if (node_cells[n] == nullptr)
+				ends.push_back(n);
+
+		std::sort(ends.begin(), ends.end(), [&](int a, int b) {
+			if (cost[a] != cost[b])
+				return cost[a] > cost[b];
+			if (length[a] != length[b])
+				return length[a] > length[b];
+			return a < b;
+		});
 
-		if (maxlvl >= 0)
-			printpath(maxbit);
+		log("\n");
+		if (ends.empty())
+			log("Longest topological path in %s (length=%d):\n", log_id(module), -1);
 
-		if (bit2ff.count(maxbit))
-			log("%5s: %s (via %s)\n", "ff", log_signal(get<0>(bit2ff.at(maxbit))), log_id(get<1>(bit2ff.at(maxbit))));
+		std::vector<bool> on_path(num_nodes);
+		int count = 0;
+		for (int n : ends)
+		{
+			if (count == num_paths)
+				break;
+			if (on_path[n])
+				continue;
+			for (int k = n; k >= 0; k = from[k])
+				on_path[k] = true;
+
+			if (count++ > 0)
+				log("\n");
+			string title = num_paths > 1 ? stringf("Topological path #%d", count) : string("Longest topological path");
+			if (cost_mode)
+				log("%s in %s (length=%d, cost=%d):\n", title.c_str(), log_id(module), length[n], cost[n]);
+			else
+				log("%s in %s (length=%d):\n", title.c_str(), log_id(module), length[n]);
+			printpath(n);
+		}
 	}
 };
 
@@ -153,10 +264,21 @@ struct LtpPass : public Pass {
 		log("    -noff\n");
 		log("        automatically exclude FF cell types\n");
 		log("\n");
+		log("    -cost\n");
+		log("        weight cells by their estimated delay instead of counting them. gate\n");
+		log("        cells use the costs from CellCosts::default_gate_cost(), coarse-grain\n");
+		log("        cells an estimate for a logarithmic-depth implementation, and instances\n");
+		log("        of modules the 'cost' attribute of the module or the sum of its cells.\n");
+		log("\n");
+		log("    -paths <N>\n");
+		log("        print the N longest paths. a path is skipped if it ends on a longer\n");
+		log("        path printed before. the default is 1.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
-		bool noff = false;
+		bool noff = false, cost_mode = false;
+		int num_paths = 1;
 
 		log_header(design, "Executing LTP pass (find longest path).\n");
 
@@ -166,6 +288,16 @@ struct LtpPass : public Pass {
 				noff = true;
 				continue;
 			}
+			if (args[argidx] == "-cost") {
+				cost_mode = true;
+				continue;
+			}
+			if (args[argidx] == "-paths" && argidx+1 < args.size()) {
+				num_paths = atoi(args[++argidx].c_str());
+				if (num_paths < 1)
+					log_cmd_error("Invalid number of paths: %s\n", args[argidx].c_str());
+				continue;
+			}
 			break;
 		}
 
@@ -176,8 +308,8 @@ struct LtpPass : public Pass {
 			if (module->has_processes_warn())
 				continue;
 
-			LtpWorker worker(module, noff);
-			worker.run();
+			LtpWorker worker(module, noff, cost_mode);
+			worker.run(num_paths);
 		}
 	}
 } LtpPass;
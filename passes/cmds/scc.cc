@@ -17,13 +17,10 @@
  *
  */
 
-// [[CITE]] Tarjan's strongly connected components algorithm
-// Tarjan, R. E. (1972), "Depth-first search and linear graph algorithms", SIAM Journal on Computing 1 (2): 146-160, doi:10.1137/0201010
-// http://en.wikipedia.org/wiki/Tarjan's_strongly_connected_components_algorithm
-
 #include "kernel/register.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
+#include "kernel/graph.h"
 #include "kernel/log.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -39,67 +36,12 @@ struct SccWorker
 	SigMap sigmap;
 	CellTypes ct, specifyCells;
 
-	std::set<RTLIL::Cell*> workQueue;
-	std::map<RTLIL::Cell*, std::set<RTLIL::Cell*>> cellToNextCell;
-	std::map<RTLIL::Cell*, RTLIL::SigSpec> cellToPrevSig, cellToNextSig;
-
-	std::map<RTLIL::Cell*, std::pair<int, int>> cellLabels;
-	std::map<RTLIL::Cell*, int> cellDepth;
-	std::set<RTLIL::Cell*> cellsOnStack;
-	std::vector<RTLIL::Cell*> cellStack;
-	int labelCounter;
+	std::vector<RTLIL::Cell*> cells;
+	dict<RTLIL::Cell*, int> cellIndex;
+	dict<RTLIL::Cell*, RTLIL::SigSpec> cellToPrevSig, cellToNextSig;
 
-	std::map<RTLIL::Cell*, int> cell2scc;
 	std::vector<std::set<RTLIL::Cell*>> sccList;
 
-	void run(RTLIL::Cell *cell, int depth, int maxDepth)
-	{
-		log_assert(workQueue.count(cell) > 0);
-
-		workQueue.erase(cell);
-		cellLabels[cell] = std::pair<int, int>(labelCounter, labelCounter);
-		labelCounter++;
-
-		cellsOnStack.insert(cell);
-		cellStack.push_back(cell);
-
-		if (maxDepth >= 0)
-			cellDepth[cell] = depth;
-
-		for (auto nextCell : cellToNextCell[cell])
-			if (cellLabels.count(nextCell) == 0) {
-				run(nextCell, depth+1, maxDepth);
-				cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
-			} else
-			if (cellsOnStack.count(nextCell) > 0 && (maxDepth < 0 || cellDepth[nextCell] + maxDepth > depth)) {
-					cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
-			}
-
-		if (cellLabels[cell].first == cellLabels[cell].second)
-		{
-			if (cellStack.back() == cell)
-			{
-				cellStack.pop_back();
-				cellsOnStack.erase(cell);
-			}
-			else
-			{
-				log("Found an SCC:");
-				std::set<RTLIL::Cell*> scc;
-				while (cellsOnStack.count(cell) > 0) {
-					RTLIL::Cell *c = cellStack.back();
-					cellStack.pop_back();
-					cellsOnStack.erase(c);
-					log(" %s", RTLIL::id2cstr(c->name));
-					cell2scc[c] = sccList.size();
-					scc.insert(c);
-				}
-				sccList.push_back(scc);
-				log("\n");
-			}
-		}
-	}
-
 	SccWorker(RTLIL::Design *design, RTLIL::Module *module, bool nofeedbackMode, bool allCellTypes, bool specifyMode, int maxDepth) :
 			design(design), module(module), sigmap(module)
 	{
@@ -144,7 +86,8 @@ struct SccWorker
 			if (!allCellTypes && !ct.cell_known(cell->type) && !specifyCells.cell_known(cell->type))
 				continue;
 
-			workQueue.insert(cell);
+			cellIndex[cell] = GetSize(cells);
+			cells.push_back(cell);
 
 			RTLIL::SigSpec inputSignals, outputSignals;
 
@@ -197,31 +140,42 @@ struct SccWorker
 			sigToNextCells.insert(inputSignals, cell);
 		}
 
-		for (auto cell : workQueue)
+		IntGraph graph(GetSize(cells));
+
+		for (int i = 0; i < GetSize(cells); i++)
 		{
-			cellToNextCell[cell] = sigToNextCells.find(cellToNextSig[cell]);
+			RTLIL::Cell *cell = cells[i];
 
-			if (!nofeedbackMode && cellToNextCell[cell].count(cell)) {
-				log("Found an SCC:");
-				std::set<RTLIL::Cell*> scc;
-				log(" %s", RTLIL::id2cstr(cell->name));
-				cell2scc[cell] = sccList.size();
-				scc.insert(cell);
-				sccList.push_back(scc);
-				log("\n");
+			for (auto nextCell : sigToNextCells.find(cellToNextSig[cell]))
+			{
+				graph.add_edge(i, cellIndex.at(nextCell));
+
+				if (!nofeedbackMode && nextCell == cell) {
+					log("Found an SCC: %s\n", RTLIL::id2cstr(cell->name));
+					sccList.push_back(std::set<RTLIL::Cell*>{cell});
+				}
 			}
 		}
 
-		labelCounter = 0;
-		cellLabels.clear();
+		graph.build();
+
+		std::vector<int> component;
+		std::vector<std::vector<RTLIL::Cell*>> componentCells(graph.scc(component, maxDepth));
+
+		for (int i = 0; i < GetSize(cells); i++)
+			componentCells[component[i]].push_back(cells[i]);
 
-		while (!workQueue.empty())
+		for (auto &members : componentCells)
 		{
-			RTLIL::Cell *cell = *workQueue.begin();
-			log_assert(cellStack.size() == 0);
-			cellDepth.clear();
+			if (GetSize(members) < 2)
+				continue;
+
+			log("Found an SCC:");
+			for (auto cell : members)
+				log(" %s", RTLIL::id2cstr(cell->name));
+			log("\n");
 
-			run(cell, 0, maxDepth);
+			sccList.push_back(std::set<RTLIL::Cell*>(members.begin(), members.end()));
 		}
 
 		log("Found %d SCCs in module %s.\n", int(sccList.size()), RTLIL::id2cstr(module->name));
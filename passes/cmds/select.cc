@@ -54,6 +54,16 @@ static bool match_ids(RTLIL::IdString id, const std::string &pattern)
 	return false;
 }
 
+// A pattern without wildcards can match only one name (see match_ids()),
+// which can then be looked up directly
+static bool exact_id_pattern(const std::string &pattern, RTLIL::IdString &id)
+{
+	if (pattern.empty() || pattern[0] == '$' || pattern.find_first_of("*?[\\") != std::string::npos)
+		return false;
+	id = "\\" + pattern;
+	return true;
+}
+
 static bool match_attr_val(const RTLIL::Const &value, const std::string &pattern, char match_op)
 {
 	if (match_op == 0)
@@ -431,6 +441,23 @@ static int parse_comma_list(std::set<RTLIL::IdString> &tokens, const std::string
 	}
 }
 
+static bool expand_rule_match(RTLIL::Cell *cell, RTLIL::IdString port, const std::vector<expand_rule_t> &rules, bool eval_only)
+{
+	if (eval_only && !yosys_celltypes.cell_evaluable(cell->type))
+		return false;
+
+	char last_mode = '-';
+	for (auto &rule : rules) {
+		last_mode = rule.mode;
+		if (rule.cell_types.size() > 0 && rule.cell_types.count(cell->type) == 0)
+			continue;
+		if (rule.port_names.size() > 0 && rule.port_names.count(port) == 0)
+			continue;
+		return rule.mode == '+';
+	}
+	return last_mode != '+';
+}
+
 static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, int max_objects, char mode, CellTypes &ct, bool eval_only)
 {
 	int sel_objects = 0;
@@ -465,23 +492,8 @@ static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::v
 		for (auto cell : mod->cells())
 		for (auto &conn : cell->connections())
 		{
-			char last_mode = '-';
-			if (eval_only && !yosys_celltypes.cell_evaluable(cell->type))
-				goto exclude_match;
-			for (auto &rule : rules) {
-				last_mode = rule.mode;
-				if (rule.cell_types.size() > 0 && rule.cell_types.count(cell->type) == 0)
-					continue;
-				if (rule.port_names.size() > 0 && rule.port_names.count(conn.first) == 0)
-					continue;
-				if (rule.mode == '+')
-					goto include_match;
-				else
-					goto exclude_match;
-			}
-			if (last_mode == '+')
-				goto exclude_match;
-		include_match:
+			if (!expand_rule_match(cell, conn.first, rules, eval_only))
+				continue;
 			is_input = mode == 'x' || ct.cell_input(cell->type, conn.first);
 			is_output = mode == 'x' || ct.cell_output(cell->type, conn.first);
 			for (auto &chunk : conn.second.chunks())
@@ -493,13 +505,116 @@ static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::v
 						if (mode == 'x' || (mode == 'i' && is_input) || (mode == 'o' && is_output))
 							lhs.selected_members[mod->name].insert(chunk.wire->name), sel_objects++, max_objects--;
 				}
-		exclude_match:;
 		}
 	}
 
 	return sel_objects;
 }
 
+namespace {
+	struct expand_port_t {
+		RTLIL::Cell *cell;
+		RTLIL::Wire *wire;
+		bool is_input, is_output;
+	};
+}
+
+// Same as calling select_op_expand() for the given number of levels without
+// an object limit. The connectivity of each module is indexed once, and every
+// level only visits the objects that were added by the previous one.
+static void select_op_expand_indexed(RTLIL::Design *design, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, int levels, char mode, CellTypes &ct, bool eval_only)
+{
+	for (auto mod : design->modules())
+	{
+		if (lhs.selected_whole_module(mod->name) || !lhs.selected_module(mod->name))
+			continue;
+
+		pool<RTLIL::IdString> &members = lhs.selected_members[mod->name];
+
+		// Other wire of each module connection, and whether it can be
+		// reached by %co (left-hand side) or by %ci (right-hand side)
+		dict<RTLIL::Wire*, std::vector<std::pair<RTLIL::Wire*, bool>>> wire_conns;
+		dict<RTLIL::Wire*, std::vector<expand_port_t>> wire_ports;
+		dict<RTLIL::Cell*, std::vector<expand_port_t>> cell_ports;
+
+		for (auto &conn : mod->connections()) {
+			for (int i = 0; i < GetSize(conn.first); i++) {
+				RTLIL::Wire *lhs_wire = conn.first[i].wire, *rhs_wire = conn.second[i].wire;
+				if (lhs_wire == nullptr || rhs_wire == nullptr)
+					continue;
+				wire_conns[rhs_wire].push_back(std::make_pair(lhs_wire, true));
+				wire_conns[lhs_wire].push_back(std::make_pair(rhs_wire, false));
+			}
+		}
+
+		for (auto cell : mod->cells())
+		for (auto &conn : cell->connections())
+		{
+			if (!expand_rule_match(cell, conn.first, rules, eval_only))
+				continue;
+			expand_port_t port;
+			port.cell = cell;
+			port.is_input = mode == 'x' || ct.cell_input(cell->type, conn.first);
+			port.is_output = mode == 'x' || ct.cell_output(cell->type, conn.first);
+			for (auto &chunk : conn.second.chunks())
+				if (chunk.wire != nullptr) {
+					port.wire = chunk.wire;
+					wire_ports[chunk.wire].push_back(port);
+					cell_ports[cell].push_back(port);
+				}
+		}
+
+		std::vector<RTLIL::Wire*> wire_queue, next_wires;
+		std::vector<RTLIL::Cell*> cell_queue, next_cells;
+
+		for (auto &name : members) {
+			if (limits.count(name))
+				continue;
+			if (RTLIL::Wire *wire = mod->wire(name))
+				wire_queue.push_back(wire);
+			else if (RTLIL::Cell *cell = mod->cell(name))
+				cell_queue.push_back(cell);
+		}
+
+		for (int level = 0; level < levels && (!wire_queue.empty() || !cell_queue.empty()); level++)
+		{
+			for (auto wire : wire_queue) {
+				auto conns_it = wire_conns.find(wire);
+				if (conns_it != wire_conns.end())
+					for (auto &it : conns_it->second)
+						if ((it.second ? mode != 'i' : mode != 'o') && members.insert(it.first->name).second)
+							next_wires.push_back(it.first);
+				auto ports_it = wire_ports.find(wire);
+				if (ports_it != wire_ports.end())
+					for (auto &port : ports_it->second)
+						if (mode == 'x' || (mode == 'i' && port.is_output) || (mode == 'o' && port.is_input))
+							if (members.insert(port.cell->name).second)
+								next_cells.push_back(port.cell);
+			}
+
+			for (auto cell : cell_queue) {
+				auto ports_it = cell_ports.find(cell);
+				if (ports_it != cell_ports.end())
+					for (auto &port : ports_it->second)
+						if (mode == 'x' || (mode == 'i' && port.is_input) || (mode == 'o' && port.is_output))
+							if (members.insert(port.wire->name).second)
+								next_wires.push_back(port.wire);
+			}
+
+			wire_queue.clear();
+			cell_queue.clear();
+			for (auto wire : next_wires)
+				if (!limits.count(wire->name))
+					wire_queue.push_back(wire);
+			for (auto cell : next_cells)
+				if (!limits.count(cell->name))
+					cell_queue.push_back(cell);
+			next_wires.clear();
+			next_cells.clear();
+		}
+	}
+}
+
 static void select_op_expand(RTLIL::Design *design, const std::string &arg, char mode, bool eval_only)
 {
 	int pos = (mode == 'x' ? 2 : 3) + (eval_only ? 1 : 0);
@@ -593,6 +708,11 @@ static void select_op_expand(RTLIL::Design *design, const std::string &arg, char
 	}
 #endif
 
+	if (rem_objects < 0) {
+		select_op_expand_indexed(design, work_stack.back(), rules, limits, levels, mode, ct, eval_only);
+		return;
+	}
+
 	while (levels-- > 0 && rem_objects != 0) {
 		int num_objects = select_op_expand(design, work_stack.back(), rules, limits, rem_objects, mode, ct, eval_only);
 		if (num_objects == 0)
@@ -828,22 +948,43 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			continue;
 		}
 
+		RTLIL::IdString memb_id;
+
 		if (arg_memb.compare(0, 2, "w:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				if (mod->wire(memb_id) != nullptr)
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto wire : mod->wires())
 				if (match_ids(wire->name, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "i:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				RTLIL::Wire *wire = mod->wire(memb_id);
+				if (wire != nullptr && wire->port_input)
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto wire : mod->wires())
 				if (wire->port_input && match_ids(wire->name, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "o:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				RTLIL::Wire *wire = mod->wire(memb_id);
+				if (wire != nullptr && wire->port_output)
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto wire : mod->wires())
 				if (wire->port_output && match_ids(wire->name, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(wire->name);
 		} else
 		if (arg_memb.compare(0, 2, "x:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				RTLIL::Wire *wire = mod->wire(memb_id);
+				if (wire != nullptr && (wire->port_input || wire->port_output))
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto wire : mod->wires())
 				if ((wire->port_input || wire->port_output) && match_ids(wire->name, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(wire->name);
@@ -866,21 +1007,38 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			}
 		} else
 		if (arg_memb.compare(0, 2, "m:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				if (mod->memories.count(memb_id))
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto &it : mod->memories)
 				if (match_ids(it.first, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(it.first);
 		} else
 		if (arg_memb.compare(0, 2, "c:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				if (mod->cell(memb_id) != nullptr)
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto cell : mod->cells())
 				if (match_ids(cell->name, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(cell->name);
 		} else
 		if (arg_memb.compare(0, 2, "t:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				for (auto cell : mod->cells())
+					if (cell->type == memb_id)
+						sel.selected_members[mod->name].insert(cell->name);
+			} else
 			for (auto cell : mod->cells())
 				if (match_ids(cell->type, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(cell->name);
 		} else
 		if (arg_memb.compare(0, 2, "p:") == 0) {
+			if (exact_id_pattern(arg_memb.substr(2), memb_id)) {
+				if (mod->processes.count(memb_id))
+					sel.selected_members[mod->name].insert(memb_id);
+			} else
 			for (auto &it : mod->processes)
 				if (match_ids(it.first, arg_memb.substr(2)))
 					sel.selected_members[mod->name].insert(it.first);
@@ -907,6 +1065,14 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			std::string orig_arg_memb = arg_memb;
 			if (arg_memb.compare(0, 2, "n:") == 0)
 				arg_memb = arg_memb.substr(2);
+			if (exact_id_pattern(arg_memb, memb_id)) {
+				if (mod->wire(memb_id) != nullptr || mod->memories.count(memb_id) ||
+						mod->cell(memb_id) != nullptr || mod->processes.count(memb_id)) {
+					sel.selected_members[mod->name].insert(memb_id);
+					arg_memb_found[orig_arg_memb] = true;
+				}
+				continue;
+			}
 			for (auto wire : mod->wires())
 				if (match_ids(wire->name, arg_memb)) {
 					sel.selected_members[mod->name].insert(wire->name);
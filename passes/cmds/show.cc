@@ -20,6 +20,8 @@
 #include "kernel/register.h"
 #include "kernel/celltypes.h"
 #include "kernel/log.h"
+#include "kernel/sigtools.h"
+#include "kernel/graph.h"
 #include <string.h>
 
 #ifndef _WIN32
@@ -65,6 +67,7 @@ struct ShowWorker
 	bool enumerateIds;
 	bool abbreviateIds;
 	bool notitle;
+	int summaryDepth;
 	int page_counter;
 
 	const std::vector<std::pair<std::string, RTLIL::Selection>> &color_selections;
@@ -589,13 +592,207 @@ struct ShowWorker
 		fprintf(f, "}\n");
 	}
 
+	// The hierarchy group of a cell for "show -summary": the first
+	// summaryDepth levels of the instance path in its hdlname attribute or
+	// flattened name, or an empty string for cells of the module itself
+	std::string summary_group(RTLIL::Cell *cell)
+	{
+		std::vector<std::string> path;
+		if (cell->has_attribute(ID::hdlname))
+			path = cell->get_hdlname_attribute();
+		else if (cell->name.isPublic())
+			path = split_tokens(cell->name.str().substr(1), ".");
+
+		if (GetSize(path) <= 1)
+			return std::string();
+
+		path.pop_back();
+		if (GetSize(path) > summaryDepth)
+			path.resize(summaryDepth);
+
+		std::string group = path.front();
+		for (int i = 1; i < GetSize(path); i++)
+			group += "." + path[i];
+		return group;
+	}
+
+	// Draws the selected cells as one node per hierarchy group, one node per
+	// loop of the remaining cells and one node per type of all other cells,
+	// with edges labelled by the number of net bits between them. Everything
+	// is hashed or indexed, so this runs in linear time in the module size.
+	void handle_module_summary()
+	{
+		single_idx_count = 0;
+		dot_escape_store.clear();
+		dot_id2num_store.clear();
+		net_conn_map.clear();
+
+		fprintf(f, "digraph \"%s\" {\n", escape(module->name.str()));
+		if (!notitle)
+			fprintf(f, "label=\"%s\";\n", escape(module->name.str()));
+		fprintf(f, "rankdir=\"LR\";\n");
+		fprintf(f, "remincross=true;\n");
+
+		SigMap sigmap(module);
+		std::vector<RTLIL::Cell*> cells = module->selected_cells();
+		std::vector<RTLIL::Wire*> ports;
+		for (auto wire : module->selected_wires())
+			if (wire->port_input || wire->port_output)
+				ports.push_back(wire);
+
+		// Items are the selected cells followed by the selected ports.
+		int num_cells = GetSize(cells);
+		dict<RTLIL::SigBit, int> bit_drivers;
+		for (int i = 0; i < num_cells; i++)
+			for (auto &conn : cells[i]->connections())
+				if (ct.cell_output(cells[i]->type, conn.first))
+					for (auto bit : sigmap(conn.second))
+						if (bit.wire)
+							bit_drivers[bit] = i;
+		for (int i = 0; i < GetSize(ports); i++)
+			if (ports[i]->port_input)
+				for (auto bit : sigmap(ports[i]))
+					bit_drivers[bit] = num_cells + i;
+
+		struct SummaryNode {
+			std::string name, shape;
+			int count;
+		};
+		std::vector<SummaryNode> nodes;
+		std::vector<int> item_nodes(num_cells + GetSize(ports), -1);
+		dict<std::string, int> group_nodes;
+
+		std::vector<int> ungrouped_index(num_cells, -1);
+		std::vector<int> ungrouped;
+		for (int i = 0; i < num_cells; i++) {
+			std::string group = summary_group(cells[i]);
+			if (group.empty()) {
+				ungrouped_index[i] = GetSize(ungrouped);
+				ungrouped.push_back(i);
+				continue;
+			}
+			auto it = group_nodes.find(group);
+			if (it == group_nodes.end()) {
+				it = group_nodes.emplace(group, GetSize(nodes)).first;
+				nodes.push_back({group, "box3d", 0});
+			}
+			item_nodes[i] = it->second;
+			nodes[it->second].count++;
+		}
+
+		// Strongly connected components of the ungrouped cells, so that
+		// each loop becomes a single node
+		IntGraph graph(GetSize(ungrouped));
+		for (int k = 0; k < GetSize(ungrouped); k++)
+			for (auto &conn : cells[ungrouped[k]]->connections())
+				if (!ct.cell_output(cells[ungrouped[k]]->type, conn.first))
+					for (auto bit : sigmap(conn.second)) {
+						auto it = bit_drivers.find(bit);
+						if (it != bit_drivers.end() && it->second < num_cells && ungrouped_index[it->second] >= 0)
+							graph.add_edge(ungrouped_index[it->second], k);
+					}
+		graph.build();
+
+		std::vector<int> component;
+		int num_components = graph.scc(component);
+		std::vector<int> component_size(num_components), component_nodes(num_components, -1);
+		for (int k = 0; k < GetSize(ungrouped); k++)
+			component_size[component[k]]++;
+
+		dict<RTLIL::IdString, int> type_nodes;
+		for (int k = 0; k < GetSize(ungrouped); k++) {
+			RTLIL::Cell *cell = cells[ungrouped[k]];
+			int &node = item_nodes[ungrouped[k]];
+			int comp = component[k];
+			if (component_size[comp] > 1 || graph.has_edge(k, k)) {
+				if (component_nodes[comp] < 0) {
+					component_nodes[comp] = GetSize(nodes);
+					nodes.push_back({stringf("loop at %s", log_id(cell)), "doubleoctagon", 0});
+				}
+				node = component_nodes[comp];
+			} else {
+				auto it = type_nodes.find(cell->type);
+				if (it == type_nodes.end()) {
+					it = type_nodes.emplace(cell->type, GetSize(nodes)).first;
+					nodes.push_back({log_id(cell->type), "box", 0});
+				}
+				node = it->second;
+			}
+			nodes[node].count++;
+		}
+
+		std::set<std::string> all_sources, all_sinks;
+		for (int i = 0; i < GetSize(ports); i++) {
+			std::string node = stringf("n%d", id2num(ports[i]->name));
+			fprintf(f, "%s [ shape=octagon, label=\"%s\", color=\"black\", fontcolor=\"black\" ];\n",
+					node.c_str(), findLabel(ports[i]->name.str()));
+			if (ports[i]->port_input)
+				all_sources.insert(node);
+			else
+				all_sinks.insert(node);
+			// ports are not summary nodes, see node_name below
+			item_nodes[num_cells + i] = -2 - i;
+		}
+
+		for (int i = 0; i < GetSize(nodes); i++)
+			fprintf(f, "g%d [ shape=%s, label=\"%s\\n%d cell%s\" ];\n", i, nodes[i].shape.c_str(),
+					escape(nodes[i].name), nodes[i].count, nodes[i].count == 1 ? "" : "s");
+
+		if (stretchIO)
+		{
+			fprintf(f, "{ rank=\"source\";");
+			for (auto n : all_sources)
+				fprintf(f, " %s;", n.c_str());
+			fprintf(f, "}\n");
+
+			fprintf(f, "{ rank=\"sink\";");
+			for (auto n : all_sinks)
+				fprintf(f, " %s;", n.c_str());
+			fprintf(f, "}\n");
+		}
+
+		// Count every bit once per pair of nodes that it connects
+		dict<std::pair<int, int>, int> edge_bits;
+		pool<std::pair<RTLIL::SigBit, int>> seen_bits;
+		auto add_reader = [&](RTLIL::SigBit bit, int to) {
+			auto it = bit_drivers.find(bit);
+			if (it == bit_drivers.end())
+				return;
+			int from = item_nodes[it->second];
+			if (from != to && seen_bits.insert({bit, to}).second)
+				edge_bits[{from, to}]++;
+		};
+		for (int i = 0; i < num_cells; i++)
+			for (auto &conn : cells[i]->connections())
+				if (!ct.cell_output(cells[i]->type, conn.first))
+					for (auto bit : sigmap(conn.second))
+						add_reader(bit, item_nodes[i]);
+		for (int i = 0; i < GetSize(ports); i++)
+			if (ports[i]->port_output)
+				for (auto bit : sigmap(ports[i]))
+					add_reader(bit, item_nodes[num_cells + i]);
+
+		auto node_name = [&](int node) {
+			if (node >= 0)
+				return stringf("g%d", node);
+			return stringf("n%d", id2num(ports[-2 - node]->name));
+		};
+		for (auto &it : edge_bits) {
+			currentColor = xorshift32(currentColor);
+			fprintf(f, "%s:e -> %s:w [%s, %s];\n", node_name(it.first.first).c_str(), node_name(it.first.second).c_str(),
+					nextColor().c_str(), widthLabel(it.second).c_str());
+		}
+
+		fprintf(f, "}\n");
+	}
+
 	ShowWorker(FILE *f, RTLIL::Design *design, std::vector<RTLIL::Design*> &libs, uint32_t colorSeed, bool genWidthLabels,
-			bool genSignedLabels, bool stretchIO, bool enumerateIds, bool abbreviateIds, bool notitle,
+			bool genSignedLabels, bool stretchIO, bool enumerateIds, bool abbreviateIds, bool notitle, int summaryDepth,
 			const std::vector<std::pair<std::string, RTLIL::Selection>> &color_selections,
 			const std::vector<std::pair<std::string, RTLIL::Selection>> &label_selections, RTLIL::IdString colorattr) :
 			f(f), design(design), currentColor(colorSeed), genWidthLabels(genWidthLabels),
 			genSignedLabels(genSignedLabels), stretchIO(stretchIO), enumerateIds(enumerateIds), abbreviateIds(abbreviateIds),
-			notitle(notitle), color_selections(color_selections), label_selections(label_selections), colorattr(colorattr)
+			notitle(notitle), summaryDepth(summaryDepth), color_selections(color_selections), label_selections(label_selections), colorattr(colorattr)
 	{
 		ct.setup_internals();
 		ct.setup_internals_mem();
@@ -624,7 +821,10 @@ struct ShowWorker
 					log("Dumping module %s to page %d.\n", log_id(module->name), ++page_counter);
 			} else
 				log("Dumping selected parts of module %s to page %d.\n", log_id(module->name), ++page_counter);
-			handle_module();
+			if (summaryDepth > 0)
+				handle_module_summary();
+			else
+				handle_module();
 		}
 	}
 };
@@ -707,6 +907,17 @@ struct ShowPass : public Pass {
 		log("        don't run viewer in the background, IE wait for the viewer tool to\n");
 		log("        exit before returning\n");
 		log("\n");
+		log("    -summary <depth>\n");
+		log("        draw a summary graph for large modules. Cells are grouped by the first\n");
+		log("        <depth> levels of their instance path, taken from the 'hdlname'\n");
+		log("        attribute or from the dot-separated name of a flattened cell. Each\n");
+		log("        loop among the remaining cells is drawn as one node, and all other\n");
+		log("        cells as one node per cell type. Edges are labelled with the number of\n");
+		log("        net bits (with -width) between the nodes. Only module ports are shown\n");
+		log("        as wires, and processes are not shown. To look into a group, select\n");
+		log("        its cells and increase the depth, e.g. 'show -summary 2 c:cpu.*'.\n");
+		log("        The -color and -label selections are ignored in this mode.\n");
+		log("\n");
 		log("When no <format> is specified, 'dot' is used. When no <format> and <viewer> is\n");
 		log("specified, 'xdot' is used to display the schematic (POSIX systems only).\n");
 		log("\n");
@@ -744,6 +955,7 @@ struct ShowPass : public Pass {
 		bool flag_enum = false;
 		bool flag_abbreviate = true;
 		bool flag_notitle = false;
+		int summary_depth = 0;
 		bool custom_prefix = false;
 		std::string background = "&";
 		RTLIL::IdString colorattr;
@@ -831,6 +1043,12 @@ struct ShowPass : public Pass {
 				background= "";
 				continue;
 			}
+			if (arg == "-summary" && argidx+1 < args.size()) {
+				summary_depth = atoi(args[++argidx].c_str());
+				if (summary_depth < 1)
+					log_cmd_error("Invalid summary depth %s.\n", args[argidx].c_str());
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -875,7 +1093,7 @@ struct ShowPass : public Pass {
 				delete lib;
 			log_cmd_error("Can't open dot file `%s' for writing.\n", dot_file.c_str());
 		}
-		ShowWorker worker(f, design, libs, colorSeed, flag_width, flag_signed, flag_stretch, flag_enum, flag_abbreviate, flag_notitle, color_selections, label_selections, colorattr);
+		ShowWorker worker(f, design, libs, colorSeed, flag_width, flag_signed, flag_stretch, flag_enum, flag_abbreviate, flag_notitle, summary_depth, color_selections, label_selections, colorattr);
 		fclose(f);
 
 		for (auto lib : libs)
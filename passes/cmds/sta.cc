@@ -19,231 +19,138 @@
  */
 
 #include "kernel/yosys.h"
-#include "kernel/sigtools.h"
-#include "kernel/timinginfo.h"
-#include <deque>
+#include "kernel/sta.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 struct StaWorker
 {
-	Design *design;
 	Module *module;
-	SigMap sigmap;
+	StaEngine sta;
 
-	struct t_data {
-		Cell* driver;
-		IdString dst_port, src_port;
-		vector<tuple<SigBit,int,IdString>> fanouts;
-		SigBit backtrack;
-		t_data() : driver(nullptr) {}
-	};
-	dict<SigBit, t_data> data;
-	std::deque<SigBit> queue;
-	struct t_endpoint {
-		Cell *sink;
-		IdString port;
-		int required;
-		t_endpoint() : sink(nullptr), required(0) {}
-	};
-	dict<SigBit, t_endpoint> endpoints;
-
-	int maxarrival;
-	SigBit maxbit;
-
-	pool<SigBit> driven;
-
-	StaWorker(RTLIL::Module *module) : design(module->design), module(module), sigmap(module), maxarrival(0)
+	StaWorker(RTLIL::Module *module) : module(module), sta(module)
 	{
-		TimingInfo timing;
-
-		pool<IdString> unrecognised_cells;
-
-		for (auto cell : module->cells())
-		{
-			Module *inst_module = design->module(cell->type);
-			if (!inst_module) {
-				if (unrecognised_cells.insert(cell->type).second)
-					log_warning("Cell type '%s' not recognised! Ignoring.\n", log_id(cell->type));
-				continue;
-			}
-
-			if (!inst_module->get_blackbox_attribute()) {
-				log_warning("Cell type '%s' is not a black- nor white-box! Ignoring.\n", log_id(cell->type));
-				continue;
-			}
-
-			IdString derived_type = inst_module->derive(design, cell->parameters);
-			inst_module = design->module(derived_type);
-			log_assert(inst_module);
-
-			if (!timing.count(derived_type)) {
-				auto &t = timing.setup_module(inst_module);
-				if (t.has_inputs && t.comb.empty() && t.arrival.empty() && t.required.empty())
-					log_warning("Module '%s' has no timing arcs!\n", log_id(cell->type));
-			}
+	}
 
-			auto &t = timing.at(derived_type);
-			if (t.comb.empty() && t.arrival.empty() && t.required.empty())
+	void log_path(const std::vector<int> &path, int end)
+	{
+		for (int i = GetSize(path)-1; i >= 0; i--) {
+			const auto &arc = sta.arcs[path[i]];
+			SigBit dst = sta.node_bits[arc.dst];
+			// internal cell nodes are reported with the arc leaving them
+			if (!dst.wire)
 				continue;
-
-			pool<std::pair<SigBit,TimingInfo::NameBit>> src_bits, dst_bits;
-
-			for (auto &conn : cell->connections()) {
-				auto rhs = sigmap(conn.second);
-				for (auto i = 0; i < GetSize(rhs); i++) {
-					const auto &bit = rhs[i];
-					if (!bit.wire)
-						continue;
-					TimingInfo::NameBit namebit(conn.first,i);
-					if (cell->input(conn.first)) {
-						src_bits.insert(std::make_pair(bit,namebit));
-
-						auto it = t.required.find(namebit);
-						if (it == t.required.end())
-							continue;
-						auto r = endpoints.insert(bit);
-						if (r.second || r.first->second.required < it->second.first) {
-							r.first->second.sink = cell;
-							r.first->second.port = conn.first;
-							r.first->second.required = it->second.first;
-						}
-					}
-					if (cell->output(conn.first)) {
-						dst_bits.insert(std::make_pair(bit,namebit));
-						auto &d = data[bit];
-						d.driver = cell;
-						d.dst_port = conn.first;
-						driven.insert(bit);
-
-						auto it = t.arrival.find(namebit);
-						if (it == t.arrival.end())
-							continue;
-						const auto &s = it->second.second;
-						if (cell->hasPort(s.name)) {
-							auto s_bit = sigmap(cell->getPort(s.name)[s.offset]);
-							if (s_bit.wire)
-								data[s_bit].fanouts.emplace_back(bit,it->second.first,s.name);
-						}
-					}
-				}
-			}
-
-			for (const auto &s : src_bits)
-				for (const auto &d : dst_bits) {
-					auto it = t.comb.find(TimingInfo::BitBit(s.second,d.second));
-					if (it == t.comb.end())
-						continue;
-					data[s.first].fanouts.emplace_back(d.first,it->second,s.second.name);
-				}
+			IdString src_port = arc.src_port;
+			if (!sta.node_bits[arc.src].wire && i > 0)
+				src_port = sta.arcs[path[i-1]].src_port;
+			log("           %s\n", log_signal(dst));
+			log("  %6d %s (%s.%s->%s)\n", sta.arrival[arc.dst], log_id(arc.cell), log_id(arc.cell->type), log_id(src_port), log_id(arc.dst_port));
 		}
 
-		for (auto port_name : module->ports) {
-			auto wire = module->wire(port_name);
-			if (wire->port_input) {
-				for (const auto &b : sigmap(wire)) {
-					queue.emplace_back(b);
-					driven.insert(b);
-				}
-				// All primary inputs to arrive at time zero
-				wire->set_intvec_attribute(ID::sta_arrival, std::vector<int>(GetSize(wire), 0));
-			}
-			if (wire->port_output)
-				for (const auto &b : sigmap(wire))
-					if (b.wire)
-						endpoints.insert(b);
+		int start = path.empty() ? end : sta.arcs[path.front()].src;
+		SigBit b = sta.node_bits[start];
+		log("  %6d   %s (%s)\n", sta.arrival[start], log_signal(b), b.wire->port_input ? "<primary input>" : "<start point>");
+	}
+
+	void log_endpoint(int n, int arrival)
+	{
+		const auto *ep = sta.endpoint_of(n);
+		SigBit b = sta.node_bits[n];
+		if (ep && ep->sink)
+			log("  %6d %s (%s.%s)\n", arrival, log_id(ep->sink), log_id(ep->sink->type), log_id(ep->port));
+		else {
+			log("  %6d (%s)\n", arrival, b.wire->port_output ? "<primary output>" : "<unknown>");
+			if (!b.wire->port_output)
+				log_warning("Critical-path does not terminate in a recognised endpoint.\n");
 		}
 	}
 
-	void run()
+	void report_critical()
 	{
-		while (!queue.empty()) {
-			auto b = queue.front();
-			queue.pop_front();
-			auto it = data.find(b);
-			if (it == data.end())
+		// The latest arrival anywhere in the module, including nets that
+		// do not end in a recognised endpoint.
+		int maxarrival = 0, maxnode = -1;
+		for (int n = 0; n < GetSize(sta.node_bits); n++) {
+			if (!sta.node_bits[n].wire || sta.arrival[n] < 0 || sta.fanin_arcs[n].empty())
 				continue;
-			const auto& src_arrivals = b.wire->get_intvec_attribute(ID::sta_arrival);
-			log_assert(GetSize(src_arrivals) == GetSize(b.wire));
-			auto src_arrival = src_arrivals[b.offset];
-			for (const auto &d : it->second.fanouts) {
-				const auto &dst_bit = std::get<0>(d);
-				auto dst_arrivals = dst_bit.wire->get_intvec_attribute(ID::sta_arrival);
-				if (dst_arrivals.empty())
-					dst_arrivals = std::vector<int>(GetSize(dst_bit.wire), -1);
-				else
-					log_assert(GetSize(dst_arrivals) == GetSize(dst_bit.wire));
-				auto &dst_arrival = dst_arrivals[dst_bit.offset];
-				auto new_arrival = src_arrival + std::get<1>(d);
-				if (dst_arrival < new_arrival) {
-					auto dst_wire = dst_bit.wire;
-					dst_arrival = std::max(dst_arrival, new_arrival);
-					dst_wire->set_intvec_attribute(ID::sta_arrival, dst_arrivals);
-					queue.emplace_back(dst_bit);
-
-					data[dst_bit].backtrack = b;
-					data[dst_bit].src_port = std::get<2>(d);
-
-					auto it = endpoints.find(dst_bit);
-					if (it != endpoints.end())
-						new_arrival += it->second.required;
-					if (new_arrival > maxarrival && driven.count(b)) {
-						maxarrival = new_arrival;
-						maxbit = dst_bit;
-					}
-				}
+			const auto *ep = sta.endpoint_of(n);
+			int arrival = sta.arrival[n] + (ep ? ep->setup : 0);
+			if (arrival > maxarrival) {
+				maxarrival = arrival;
+				maxnode = n;
 			}
 		}
 
-		auto b = maxbit;
-		if (b == SigBit()) {
+		if (maxnode < 0) {
 			log("No timing paths found.\n");
 			return;
 		}
 
 		log("Latest arrival time in '%s' is %d:\n", log_id(module), maxarrival);
-		auto it = endpoints.find(maxbit);
-		if (it != endpoints.end() && it->second.sink)
-			log("  %6d %s (%s.%s)\n", maxarrival, log_id(it->second.sink), log_id(it->second.sink->type), log_id(it->second.port));
-		else {
-			log("  %6d (%s)\n", maxarrival, b.wire->port_output ? "<primary output>" : "<unknown>");
-			if (!b.wire->port_output)
-				log_warning("Critical-path does not terminate in a recognised endpoint.\n");
+		log_endpoint(maxnode, maxarrival);
+		log_path(sta.backtrack(maxnode), maxnode);
+	}
+
+	void report_paths(int count)
+	{
+		auto paths = sta.worst_paths(count);
+		for (int i = 0; i < GetSize(paths); i++) {
+			const auto &p = paths[i];
+			log("\n");
+			log("Path %d in '%s': slack %d (arrival %d, required %d):\n", i+1, log_id(module),
+					p.required - p.arrival, p.arrival, p.required);
+			log_endpoint(p.node, p.arrival);
+			log_path(p.arcs, p.node);
 		}
-		auto jt = data.find(b);
-		while (jt != data.end()) {
-			int arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
-			if (jt->second.driver) {
-				log("           %s\n", log_signal(b));
-				log("  %6d %s (%s.%s->%s)\n", arrival, log_id(jt->second.driver), log_id(jt->second.driver->type), log_id(jt->second.src_port), log_id(jt->second.dst_port));
+	}
+
+	void report_slack()
+	{
+		struct ClockSummary {
+			int endpoints = 0, failing = 0;
+			int worst_slack = 0;
+			int64_t total_negative = 0;
+		};
+		std::map<std::string, ClockSummary> summary;
+
+		for (auto &it : sta.endpoints) {
+			int n = it.first;
+			if (sta.arrival[n] < 0)
+				continue;
+			const auto *ep = sta.endpoint_of(n);
+			int slack = sta.endpoint_required(n) + ep->setup - (sta.arrival[n] + ep->setup);
+			auto &s = summary[ep->clock.wire ? log_signal(ep->clock) : "<unclocked>"];
+			if (s.endpoints == 0 || slack < s.worst_slack)
+				s.worst_slack = slack;
+			s.endpoints++;
+			if (slack < 0) {
+				s.failing++;
+				s.total_negative += slack;
 			}
-			else if (b.wire->port_input)
-				log("  %6d   %s (%s)\n", arrival, log_signal(b), "<primary input>");
-			else
-				log_abort();
-			b = jt->second.backtrack;
-			jt = data.find(b);
 		}
 
-		std::map<int, unsigned> arrival_histogram;
-		for (const auto &i : endpoints) {
-			const auto &b = i.first;
-			if (!driven.count(b))
-				continue;
+		log("\n");
+		for (auto &it : summary)
+			log("Clock %s: worst slack %d, total negative slack %lld, %d of %d endpoint(s) failing.\n", it.first.c_str(),
+					it.second.worst_slack, (long long)it.second.total_negative, it.second.failing, it.second.endpoints);
+	}
 
-			if (!b.wire->attributes.count(ID::sta_arrival)) {
-				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
+	void report_histogram()
+	{
+		std::map<int, unsigned> arrival_histogram;
+		for (const auto &i : sta.endpoints) {
+			int n = i.first;
+			SigBit b = sta.node_bits[n];
+			if (sta.arrival[n] < 0) {
+				if (!sta.fanin_arcs[n].empty())
+					log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
 				continue;
 			}
-
-			auto arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
-			if (arrival < 0) {
-				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
+			if (sta.fanin_arcs[n].empty() && !sta.is_source[n])
 				continue;
-			}
-			arrival += i.second.required;
-			arrival_histogram[arrival]++;
+
+			arrival_histogram[sta.arrival[n] + sta.endpoint_of(n)->setup]++;
 		}
 		// Adapted from https://github.com/YosysHQ/nextpnr/blob/affb12cc27ebf409eade062c4c59bb98569d8147/common/timing.cc#L946-L969
 		if (arrival_histogram.size() > 0) {
@@ -271,6 +178,29 @@ struct StaWorker
 						(bins[i] * bar_width) % max_freq > 0 ? '+' : ' ');
 		}
 	}
+
+	void annotate()
+	{
+		// Like the old engine, annotate one wire per net: the one that
+		// sigmap picks. Values left over from an earlier run are removed.
+		dict<RTLIL::Wire*, std::vector<int>> arrivals;
+		for (int n = 0; n < GetSize(sta.node_bits); n++) {
+			SigBit bit = sta.node_bits[n];
+			if (!bit.wire || sta.arrival[n] < 0)
+				continue;
+			auto &vec = arrivals[bit.wire];
+			if (vec.empty())
+				vec.resize(GetSize(bit.wire), -1);
+			vec[bit.offset] = sta.arrival[n];
+		}
+		for (auto wire : module->wires()) {
+			auto it = arrivals.find(wire);
+			if (it == arrivals.end())
+				wire->attributes.erase(ID::sta_arrival);
+			else
+				wire->set_intvec_attribute(ID::sta_arrival, it->second);
+		}
+	}
 };
 
 struct StaPass : public Pass {
@@ -284,22 +214,58 @@ struct StaPass : public Pass {
 		log("This command performs static timing analysis on the design. (Only considers\n");
 		log("paths within a single module, so the design must be flattened.)\n");
 		log("\n");
+		log("Timing arcs are taken from the specify blocks of black-box cells. The latest\n");
+		log("arrival time of every net is stored in the (* sta_arrival *) attribute of\n");
+		log("one of its wires; the attribute is removed from all other wires.\n");
+		log("\n");
+		log("    -period <time>\n");
+		log("        required time at all endpoints not captured by a clock given with\n");
+		log("        -clock. Without this option the latest arrival time is used, so the\n");
+		log("        critical path has zero slack.\n");
+		log("\n");
+		log("    -clock <wire> <period>\n");
+		log("        required time at endpoints captured by the given clock wire. This\n");
+		log("        option can be used multiple times.\n");
+		log("\n");
+		log("    -paths <count>\n");
+		log("        report the given number of worst paths by slack, one per endpoint,\n");
+		log("        followed by a slack summary for each clock\n");
+		log("\n");
+		log("    -internal <delay>\n");
+		log("        also time built-in cells, using the given delay for every\n");
+		log("        combinational arc through a cell. Flip-flops and memories start and\n");
+		log("        end paths.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing STA pass (static timing analysis).\n");
 
-		/*
+		int period = -1, paths = 0, internal_delay = -1;
+		std::vector<std::pair<std::string, int>> clocks;
+
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
-			if (args[argidx] == "-TODO") {
+			if (args[argidx] == "-period" && argidx+1 < args.size()) {
+				period = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-clock" && argidx+2 < args.size()) {
+				std::string name = args[++argidx];
+				clocks.emplace_back(name, atoi(args[++argidx].c_str()));
+				continue;
+			}
+			if (args[argidx] == "-paths" && argidx+1 < args.size()) {
+				paths = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-internal" && argidx+1 < args.size()) {
+				internal_delay = atoi(args[++argidx].c_str());
 				continue;
 			}
 			break;
 		}
-		*/
-
-		extra_args(args, 1, design);
+		extra_args(args, argidx, design);
 
 		for (Module *module : design->selected_modules())
 		{
@@ -307,7 +273,27 @@ struct StaPass : public Pass {
 				continue;
 
 			StaWorker worker(module);
-			worker.run();
+			worker.sta.internal_delay = internal_delay;
+			worker.sta.default_period = period;
+			worker.sta.setup();
+			for (auto &it : clocks) {
+				Wire *wire = module->wire(RTLIL::escape_id(it.first));
+				if (wire == nullptr) {
+					log_warning("Clock wire '%s' not found in module '%s'.\n", it.first.c_str(), log_id(module));
+					continue;
+				}
+				for (auto bit : worker.sta.sigmap(wire))
+					worker.sta.clock_period[bit] = it.second;
+			}
+			worker.sta.run();
+
+			worker.report_critical();
+			if (paths > 0 || period >= 0 || !clocks.empty()) {
+				worker.report_paths(std::max(paths, 1));
+				worker.report_slack();
+			}
+			worker.report_histogram();
+			worker.annotate();
 		}
 	}
 } StaPass;
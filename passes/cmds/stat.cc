@@ -100,12 +100,19 @@ struct statdata_t
 			num_memory_bits += it.second->width * it.second->size;
 		}
 
+		// Count per type first and merge into the ordered num_cells_by_type
+		// map once per type afterwards
+		dict<RTLIL::IdString, unsigned int> type_count;
+		dict<std::tuple<RTLIL::IdString, int, int>, RTLIL::IdString> width_types;
+
 		for (auto cell : mod->selected_cells())
 		{
 			RTLIL::IdString cell_type = cell->type;
 
 			if (width_mode)
 			{
+				int width = -1, width2 = -1;
+
 				if (cell_type.in(ID($not), ID($pos), ID($neg),
 						ID($logic_not), ID($logic_and), ID($logic_or),
 						ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor), ID($reduce_bool),
@@ -116,32 +123,53 @@ struct statdata_t
 					int width_a = cell->hasPort(ID::A) ? GetSize(cell->getPort(ID::A)) : 0;
 					int width_b = cell->hasPort(ID::B) ? GetSize(cell->getPort(ID::B)) : 0;
 					int width_y = cell->hasPort(ID::Y) ? GetSize(cell->getPort(ID::Y)) : 0;
-					cell_type = stringf("%s_%d", cell_type.c_str(), max<int>({width_a, width_b, width_y}));
+					width = max<int>({width_a, width_b, width_y});
 				}
 				else if (cell_type.in(ID($mux), ID($pmux)))
-					cell_type = stringf("%s_%d", cell_type.c_str(), GetSize(cell->getPort(ID::Y)));
-				else if (cell_type == ID($bmux))
-					cell_type = stringf("%s_%d_%d", cell_type.c_str(), GetSize(cell->getPort(ID::Y)), GetSize(cell->getPort(ID::S)));
-				else if (cell_type == ID($demux))
-					cell_type = stringf("%s_%d_%d", cell_type.c_str(), GetSize(cell->getPort(ID::A)), GetSize(cell->getPort(ID::S)));
+					width = GetSize(cell->getPort(ID::Y));
+				else if (cell_type == ID($bmux)) {
+					width = GetSize(cell->getPort(ID::Y));
+					width2 = GetSize(cell->getPort(ID::S));
+				}
+				else if (cell_type == ID($demux)) {
+					width = GetSize(cell->getPort(ID::A));
+					width2 = GetSize(cell->getPort(ID::S));
+				}
 				else if (cell_type.in(
 						ID($sr), ID($ff), ID($dff), ID($dffe), ID($dffsr), ID($dffsre),
 						ID($adff), ID($adffe), ID($sdff), ID($sdffe), ID($sdffce),
 						ID($aldff), ID($aldffe), ID($dlatch), ID($adlatch), ID($dlatchsr)))
-					cell_type = stringf("%s_%d", cell_type.c_str(), GetSize(cell->getPort(ID::Q)));
+					width = GetSize(cell->getPort(ID::Q));
+
+				if (width >= 0) {
+					auto key = std::make_tuple(cell_type, width, width2);
+					auto it = width_types.find(key);
+					if (it == width_types.end()) {
+						RTLIL::IdString annotated = width2 < 0 ? stringf("%s_%d", cell_type.c_str(), width) :
+								stringf("%s_%d_%d", cell_type.c_str(), width, width2);
+						it = width_types.emplace(key, annotated).first;
+					}
+					cell_type = it->second;
+				}
 			}
 
+			// Areas are summed per cell in cell order, so that the floating
+			// point result does not depend on how cells are grouped
 			if (!cell_area.empty()) {
-				if (cell_area.count(cell_type))
-					area += cell_area.at(cell_type);
+				auto area_it = cell_area.find(cell_type);
+				if (area_it != cell_area.end())
+					area += area_it->second;
 				else
 					unknown_cell_area.insert(cell_type);
 			}
 
 			num_cells++;
-			num_cells_by_type[cell_type]++;
+			type_count[cell_type]++;
 		}
 
+		for (auto &it : type_count)
+			num_cells_by_type[it.first] += it.second;
+
 		for (auto &it : mod->processes) {
 			if (!design->selected(mod, it.second))
 				continue;
@@ -306,23 +334,36 @@ struct statdata_t
 	}
 };
 
-statdata_t hierarchy_worker(std::map<RTLIL::IdString, statdata_t> &mod_stat, RTLIL::IdString mod, int level, bool quiet = false)
+void hierarchy_log(const std::map<RTLIL::IdString, statdata_t> &mod_stat, RTLIL::IdString mod, int level)
 {
+	for (auto &it : mod_stat.at(mod).num_cells_by_type)
+		if (mod_stat.count(it.first) > 0) {
+			log("     %*s%-*s %6u\n", 2*level, "", 26-2*level, log_id(it.first), it.second);
+			hierarchy_log(mod_stat, it.first, level+1);
+		}
+}
+
+// Totals of a module including everything instantiated below it. Each module
+// is only summed once, however often it occurs in the hierarchy.
+const statdata_t &hierarchy_worker(const std::map<RTLIL::IdString, statdata_t> &mod_stat, RTLIL::IdString mod, dict<RTLIL::IdString, statdata_t> &totals)
+{
+	auto cached = totals.find(mod);
+	if (cached != totals.end())
+		return cached->second;
+
 	statdata_t mod_data = mod_stat.at(mod);
 	std::map<RTLIL::IdString, unsigned int, RTLIL::sort_by_id_str> num_cells_by_type;
 	num_cells_by_type.swap(mod_data.num_cells_by_type);
 
 	for (auto &it : num_cells_by_type)
 		if (mod_stat.count(it.first) > 0) {
-			if (!quiet)
-				log("     %*s%-*s %6u\n", 2*level, "", 26-2*level, log_id(it.first), it.second);
-			mod_data = mod_data + hierarchy_worker(mod_stat, it.first, level+1, quiet) * it.second;
+			mod_data = mod_data + hierarchy_worker(mod_stat, it.first, totals) * it.second;
 			mod_data.num_cells -= it.second;
 		} else {
 			mod_data.num_cells_by_type[it.first] += it.second;
 		}
 
-	return mod_data;
+	return totals[mod] = mod_data;
 }
 
 void read_liberty_cellarea(dict<IdString, double> &cell_area, string liberty_file)
@@ -465,9 +506,11 @@ struct StatPass : public Pass {
 				log("=== design hierarchy ===\n");
 				log("\n");
 				log("   %-28s %6d\n", log_id(top_mod->name), 1);
+				hierarchy_log(mod_stat, top_mod->name, 0);
 			}
 
-			statdata_t data = hierarchy_worker(mod_stat, top_mod->name, 0, /*quiet=*/json_mode);
+			dict<RTLIL::IdString, statdata_t> totals;
+			statdata_t data = hierarchy_worker(mod_stat, top_mod->name, totals);
 
 			if (json_mode)
 				data.log_data_json("design", true);
@@ -20,7 +20,7 @@
 #include "kernel/yosys.h"
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
-#include "kernel/utils.h"
+#include "kernel/graph.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -71,12 +71,22 @@ struct TorderPass : public Pass {
 			log("module %s\n", log_id(module));
 
 			SigMap sigmap(module);
-			dict<SigBit, pool<IdString>> bit_drivers, bit_users;
-			TopoSort<IdString, RTLIL::sort_by_id_str> toposort;
+			dict<SigBit, pool<int>> bit_drivers, bit_users;
+			std::vector<RTLIL::Cell*> cells;
 
 			for (auto cell : module->selected_cells())
-			for (auto conn : cell->connections())
+				cells.push_back(cell);
+			std::sort(cells.begin(), cells.end(), RTLIL::sort_by_name_str<RTLIL::Cell>());
+
+			// Node ids follow the cell names, so that the order below is the
+			// order in which a depth-first search over the drivers of the
+			// cells, taken in name order, completes them.
+			std::vector<bool> is_node(GetSize(cells));
+
+			for (int i = 0; i < GetSize(cells); i++)
+			for (auto conn : cells[i]->connections())
 			{
+				Cell *cell = cells[i];
 				if (stop_db.count(cell->type) && stop_db.at(cell->type).count(conn.first))
 					continue;
 
@@ -89,33 +99,42 @@ struct TorderPass : public Pass {
 
 				if (cell->input(conn.first))
 					for (auto bit : sigmap(conn.second))
-						bit_users[bit].insert(cell->name);
+						bit_users[bit].insert(i);
 
 				if (cell->output(conn.first))
 					for (auto bit : sigmap(conn.second))
-						bit_drivers[bit].insert(cell->name);
+						bit_drivers[bit].insert(i);
 
-				toposort.node(cell->name);
+				is_node[i] = true;
 			}
 
+			// Edges point from a cell to the cells driving its inputs
+			IntGraph graph(GetSize(cells));
 			for (auto &it : bit_users)
 				if (bit_drivers.count(it.first))
-					for (auto driver_cell : bit_drivers.at(it.first))
-					for (auto user_cell : it.second)
-						toposort.edge(driver_cell, user_cell);
-
-			toposort.analyze_loops = true;
-			toposort.sort();
-
-			for (auto &it : toposort.loops) {
+					for (int driver_cell : bit_drivers.at(it.first))
+					for (int user_cell : it.second)
+						graph.add_edge(user_cell, driver_cell);
+			graph.build();
+
+			std::vector<int> component;
+			std::vector<std::vector<int>> members(graph.scc(component));
+			for (int i = 0; i < GetSize(cells); i++)
+				if (is_node[i])
+					members[component[i]].push_back(i);
+
+			for (auto &it : members) {
+				if (it.empty() || (GetSize(it) == 1 && !graph.has_edge(it.front(), it.front())))
+					continue;
 				log("  loop");
-				for (auto cell : it)
-					log(" %s", log_id(cell));
+				for (int i : it)
+					log(" %s", log_id(cells[i]));
 				log("\n");
 			}
 
-			for (auto cell : toposort.sorted)
-					log("  cell %s\n", log_id(cell));
+			for (auto &it : members)
+				for (int i : it)
+					log("  cell %s\n", log_id(cells[i]));
 		}
 	}
 } TorderPass;
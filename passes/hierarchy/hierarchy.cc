@@ -688,6 +688,32 @@ int find_top_mod_score(Design *design, Module *module, dict<Module*, int> &db)
 	return db.at(module);
 }
 
+// Give a derived top module the name that was asked for. Unless another cell
+// already instantiates the derived module, it is renamed in place instead of
+// being copied.
+RTLIL::Module *rename_top_mod(Design *design, Module *top_mod, IdString top_name)
+{
+	bool in_use = false;
+	for (auto mod : design->modules())
+		for (auto cell : mod->cells())
+			if (cell->type == top_mod->name)
+				in_use = true;
+
+	Module *old_mod = design->module(top_name);
+	if (old_mod)
+		design->remove(old_mod);
+
+	if (!in_use) {
+		design->rename(top_mod, top_name);
+		return top_mod;
+	}
+
+	Module *m = top_mod->clone();
+	m->name = top_name;
+	design->add(m);
+	return m;
+}
+
 RTLIL::Module *check_if_top_has_changed(Design *design, Module *top_mod)
 {
 	if(top_mod != NULL && top_mod->get_bool_attribute(ID::initial_top))
@@ -946,15 +972,8 @@ struct HierarchyPass : public Pass {
 			else if (top_mod != nullptr && !top_parameters.empty())
 				top_mod = design->module(top_mod->derive(design, top_parameters));
 
-			if (top_mod != nullptr && top_mod->name != top_name) {
-				Module *m = top_mod->clone();
-				m->name = top_name;
-				Module *old_mod = design->module(top_name);
-				if (old_mod)
-					design->remove(old_mod);
-				design->add(m);
-				top_mod = m;
-			}
+			if (top_mod != nullptr && top_mod->name != top_name)
+				top_mod = rename_top_mod(design, top_mod, top_name);
 		}
 
 		if (top_mod == nullptr && !load_top_mod.empty()) {
@@ -1011,15 +1030,8 @@ struct HierarchyPass : public Pass {
 
 			top_mod = design->module(top_mod->derive(design, top_parameters));
 
-			if (top_mod != nullptr && top_mod->name != top_name) {
-				Module *m = top_mod->clone();
-				m->name = top_name;
-				Module *old_mod = design->module(top_name);
-				if (old_mod)
-					design->remove(old_mod);
-				design->add(m);
-				top_mod = m;
-			}
+			if (top_mod != nullptr && top_mod->name != top_name)
+				top_mod = rename_top_mod(design, top_mod, top_name);
 		}
 
 		if ((flag_simcheck || flag_smtcheck) && top_mod == nullptr)
@@ -56,46 +56,52 @@ struct UniquifyPass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
-		bool did_something = true;
+		// Modules are processed top-down one level at a time, so that every
+		// cell is visited once and each new copy is only scanned for its own
+		// submodules.
+		std::vector<Module*> worklist;
 		int count = 0;
 
-		while (did_something)
+		for (auto module : design->selected_modules())
+			if (module->get_bool_attribute(ID::unique) || module->get_bool_attribute(ID::top))
+				worklist.push_back(module);
+
+		while (!worklist.empty())
 		{
-			did_something = false;
+			std::vector<Module*> new_modules;
 
-			for (auto module : design->selected_modules())
+			for (auto module : worklist)
+			for (auto cell : module->selected_cells())
 			{
-				if (!module->get_bool_attribute(ID::unique) && !module->get_bool_attribute(ID::top))
-					continue;
+				Module *tmod = design->module(cell->type);
+				IdString newname = module->name.str() + "." + log_id(cell->name);
 
-				for (auto cell : module->selected_cells())
-				{
-					Module *tmod = design->module(cell->type);
-					IdString newname = module->name.str() + "." + log_id(cell->name);
-
-					if (tmod == nullptr)
-						continue;
+				if (tmod == nullptr)
+					continue;
 
-					if (tmod->get_blackbox_attribute())
-						continue;
+				if (tmod->get_blackbox_attribute())
+					continue;
 
-					if (tmod->get_bool_attribute(ID::unique) && newname == tmod->name)
-						continue;
+				if (tmod->get_bool_attribute(ID::unique) && newname == tmod->name)
+					continue;
 
-					log("Creating module %s from %s.\n", log_id(newname), log_id(tmod));
+				log("Creating module %s from %s.\n", log_id(newname), log_id(tmod));
 
-					auto smod = tmod->clone();
-					smod->name = newname;
-					cell->type = newname;
-					smod->set_bool_attribute(ID::unique);
-					if (smod->attributes.count(ID::hdlname) == 0)
-						smod->attributes[ID::hdlname] = string(log_id(tmod->name));
-					design->add(smod);
+				auto smod = tmod->clone();
+				smod->name = newname;
+				cell->type = newname;
+				smod->set_bool_attribute(ID::unique);
+				if (smod->attributes.count(ID::hdlname) == 0)
+					smod->attributes[ID::hdlname] = string(log_id(tmod->name));
+				design->add(smod);
 
-					did_something = true;
-					count++;
-				}
+				if (design->selected_module(smod))
+					new_modules.push_back(smod);
+				count++;
 			}
+
+			// visit the new copies in the order design->modules() lists them
+			worklist.assign(new_modules.rbegin(), new_modules.rend());
 		}
 
 		log("Created %d unique modules.\n", count);
@@ -22,6 +22,7 @@
 #include "kernel/register.h"
 #include "kernel/rtlil.h"
 #include "kernel/sigtools.h"
+#include "kernel/sta.h"
 #include <algorithm>
 
 #include <stdio.h>
@@ -332,13 +333,42 @@ ExtSigSpec find_shared_operand(const OpMuxConn* seed, std::vector<const OpMuxCon
 	return ExtSigSpec();
 }
 
+// Estimated arrival time at the $mux output after moving the $mux in front
+// of the merged operator
+int merged_arrival(const StaEngine &sta, RTLIL::Cell *mux, const std::vector<const OpMuxConn *> &ports, const ExtSigSpec &shared_operand, const SigMap &sigmap)
+{
+	RTLIL::SigSpec mux_s = mux->getPort(ID::S);
+	int mux_delay = StaEngine::estimate_delay(mux);
+	int op_delay = StaEngine::estimate_delay(ports[0]->op);
+
+	int shared_arrival = 0;
+	for (auto bit : shared_operand.sig)
+		shared_arrival = std::max(shared_arrival, sta.arrival_of(bit));
+
+	int muxed_arrival = 0;
+	for (auto p : ports) {
+		RTLIL::IdString muxed_port_name = ID::A;
+		if (decode_port(p->op, ID::A, sigmap) == shared_operand)
+			muxed_port_name = ID::B;
+		for (auto bit : p->op->getPort(muxed_port_name))
+			muxed_arrival = std::max(muxed_arrival, sta.arrival_of(bit));
+		if (p->mux_port_id < GetSize(mux_s))
+			muxed_arrival = std::max(muxed_arrival, sta.arrival_of(mux_s[p->mux_port_id]));
+	}
+
+	// The original $mux only stays in the path if it has other inputs
+	if (GetSize(ports) <= GetSize(mux_s))
+		return std::max(shared_arrival, muxed_arrival + mux_delay) + op_delay + mux_delay;
+	return std::max(shared_arrival, muxed_arrival + mux_delay) + op_delay;
+}
+
 struct OptSharePass : public Pass {
 	OptSharePass() : Pass("opt_share", "merge mutually exclusive cells of the same type that share an input signal") {}
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    opt_share [selection]\n");
+		log("    opt_share [options] [selection]\n");
 		log("\n");
 
 		log("This pass identifies mutually exclusive cells of the same type that:\n");
@@ -348,16 +378,42 @@ struct OptSharePass : public Pass {
 		log("allowing the cell to be merged and the multiplexer to be moved from\n");
 		log("multiplexing its output to multiplexing the non-shared input signals.\n");
 		log("\n");
+		log("    -timing\n");
+		log("        Do not merge cells if moving the multiplexer in front of the merged\n");
+		log("        cell makes the multiplexed output arrive after its required time.\n");
+		log("        Arrival and required times are estimated by 'sta' with rough delays\n");
+		log("        for built-in cells, once per module before any merge.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 
 		log_header(design, "Executing OPT_SHARE pass.\n");
 
-		extra_args(args, 1, design);
+		bool timing = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-timing") {
+				timing = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
 		for (auto module : design->selected_modules()) {
 			SigMap sigmap(module);
 
+			StaEngine sta(module);
+			int depth_before = 0;
+			if (timing) {
+				sta.estimate_delays = true;
+				sta.setup();
+				sta.run();
+				depth_before = sta.worst_arrival();
+			}
+
 			dict<RTLIL::SigBit, int> bit_users;
 
 			for (auto cell : module->cells())
@@ -537,6 +593,18 @@ struct OptSharePass : public Pass {
 					if (mergeable_conns.size() < 2)
 						continue;
 
+					if (timing) {
+						int arrival = merged_arrival(sta, mux, mergeable_conns, shared_operand, sigmap);
+						int required = INT_MAX;
+						for (auto bit : mux->getPort(ID::Y).extract(seed->mux_port_offset, seed->sig.size()))
+							required = std::min(required, sta.required_of(bit));
+						if (arrival > required) {
+							log("    Not merging cells in front of %s %s: estimated arrival %d exceeds required time %d.\n",
+									log_id(mux->type), log_id(mux), arrival, required);
+							continue;
+						}
+					}
+
 					// Remember the combination for the merger
 					std::vector<OpMuxConn> merged_ports;
 					for (auto p : mergeable_conns) {
@@ -564,6 +632,13 @@ struct OptSharePass : public Pass {
 
 				merge_operators(module, shared.mux, shared.ports, shared.shared_operand, sigmap);
 			}
+
+			if (timing && !merged_ops.empty()) {
+				sta.setup();
+				sta.run();
+				log("    Estimated worst depth of module %s: %d before, %d after.\n",
+						log_id(module), depth_before, sta.worst_arrival());
+			}
 		}
 	}
 
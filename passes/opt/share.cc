@@ -23,6 +23,7 @@
 #include "kernel/modtools.h"
 #include "kernel/utils.h"
 #include "kernel/macc.h"
+#include "kernel/sta.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -36,6 +37,7 @@ struct ShareWorkerConfig
 	bool opt_force;
 	bool opt_aggressive;
 	bool opt_fast;
+	bool opt_timing;
 	pool<RTLIL::IdString> generic_uni_ops, generic_bin_ops, generic_cbin_ops, generic_other_ops;
 };
 
@@ -58,6 +60,8 @@ struct ShareWorker
 	std::map<RTLIL::Cell*, std::set<RTLIL::Cell*, cell_ptr_cmp>, cell_ptr_cmp> topo_cell_drivers;
 	std::map<RTLIL::SigBit, std::set<RTLIL::Cell*, cell_ptr_cmp>> topo_bit_drivers;
 
+	StaEngine *sta = nullptr;
+
 
 	// ------------------------------------------------------------------------------
 	// Find terminal bits -- i.e. bits that do not (exclusively) feed into a mux tree
@@ -1108,6 +1112,35 @@ struct ShareWorker
 	}
 
 
+	// -----------------------------------------------------------
+	// Check that a new supercell does not increase the worst depth
+	// -----------------------------------------------------------
+
+	bool check_timing(RTLIL::Cell *cell, RTLIL::Cell *other_cell, const pool<RTLIL::Cell*> &supercell_aux)
+	{
+		int old_depth = sta->worst_arrival();
+
+		sta->remove_cell(cell);
+		sta->remove_cell(other_cell);
+		for (auto c : supercell_aux)
+			sta->update_cell(c);
+		sta->update();
+
+		int new_depth = sta->worst_arrival();
+		if (new_depth <= old_depth)
+			return true;
+
+		log("      Sharing would increase the estimated worst depth from %d to %d.\n", old_depth, new_depth);
+
+		for (auto c : supercell_aux)
+			sta->remove_cell(c);
+		sta->update_cell(cell);
+		sta->update_cell(other_cell);
+		sta->update();
+		return false;
+	}
+
+
 	// -------------
 	// Setup and run
 	// -------------
@@ -1171,6 +1204,18 @@ struct ShareWorker
 		log("Found %d cells in module %s that may be considered for resource sharing.\n",
 				GetSize(shareable_cells), log_id(module));
 
+		StaEngine module_sta(module);
+		int depth_before = 0;
+		sta = nullptr;
+
+		if (config.opt_timing) {
+			module_sta.estimate_delays = true;
+			module_sta.setup();
+			module_sta.run();
+			depth_before = module_sta.worst_arrival();
+			sta = &module_sta;
+		}
+
 		while (!shareable_cells.empty() && config.limit != 0)
 		{
 			RTLIL::Cell *cell = *shareable_cells.begin();
@@ -1351,12 +1396,18 @@ struct ShareWorker
 				cells_to_remove.insert(other_cell);
 
 				for (auto c : supercell_aux)
-					if (is_part_of_scc(c))
+					if (is_part_of_scc(c)) {
+						log("      New topology contains loops! Rolling back..\n");
 						goto do_rollback;
+					}
+
+				if (sta != nullptr && !check_timing(cell, other_cell, supercell_aux)) {
+					log("      Rolling back..\n");
+					goto do_rollback;
+				}
 
 				if (0) {
 			do_rollback:
-					log("      New topology contains loops! Rolling back..\n");
 					cells_to_remove.erase(cell);
 					cells_to_remove.erase(other_cell);
 					shareable_cells.insert(other_cell);
@@ -1397,6 +1448,14 @@ struct ShareWorker
 			}
 		}
 
+		if (sta != nullptr) {
+			module_sta.setup();
+			module_sta.run();
+			log("Estimated worst depth of module %s: %d before, %d after resource sharing.\n",
+					log_id(module), depth_before, module_sta.worst_arrival());
+			sta = nullptr;
+		}
+
 		log_assert(recursion_state.empty());
 
 	#ifndef NDEBUG
@@ -1439,6 +1498,12 @@ struct SharePass : public Pass {
 		log("  -limit N\n");
 		log("    Only perform the first N merges, then stop. This is useful for debugging.\n");
 		log("\n");
+		log("  -timing\n");
+		log("    Do not share a resource between two cells if the $mux cells added in\n");
+		log("    front of the shared cell would increase the worst depth of the module,\n");
+		log("    as estimated by 'sta' with rough delays for built-in cells. The estimate\n");
+		log("    is updated after every merge.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -1448,6 +1513,7 @@ struct SharePass : public Pass {
 		config.opt_force = false;
 		config.opt_aggressive = false;
 		config.opt_fast = false;
+		config.opt_timing = false;
 
 		config.generic_uni_ops.insert(ID($not));
 		// config.generic_uni_ops.insert(ID($pos));
@@ -1509,6 +1575,10 @@ struct SharePass : public Pass {
 				config.limit = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (args[argidx] == "-timing") {
+				config.opt_timing = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -1128,9 +1128,13 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 		RTLIL::Module *mapped_mod = mapped_design->module(ID(netlist));
 		if (mapped_mod == nullptr)
 			log_error("ABC output file does not contain a module `netlist'.\n");
+		// Map every wire of the ABC netlist once, so that re-integrating the
+		// cells below does not have to rebuild the remapped names per port.
+		dict<RTLIL::Wire*, RTLIL::Wire*> mapped_wires;
 		for (auto w : mapped_mod->wires()) {
 			RTLIL::Wire *orig_wire = nullptr;
 			RTLIL::Wire *wire = module->addWire(remap_name(w->name, &orig_wire));
+			mapped_wires[w] = wire;
 			if (orig_wire != nullptr && orig_wire->attributes.count(ID::src))
 				wire->attributes[ID::src] = orig_wire->attributes[ID::src];
 			if (markgroups) wire->attributes[ID::abcgroup] = map_autoidx;
@@ -1148,18 +1152,15 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 				cell_stats[RTLIL::unescape_id(c->type)]++;
 				if (c->type.in(ID(ZERO), ID(ONE))) {
 					RTLIL::SigSig conn;
-					RTLIL::IdString name_y = remap_name(c->getPort(ID::Y).as_wire()->name);
-					conn.first = module->wire(name_y);
+					conn.first = mapped_wires.at(c->getPort(ID::Y).as_wire());
 					conn.second = RTLIL::SigSpec(c->type == ID(ZERO) ? 0 : 1, 1);
 					module->connect(conn);
 					continue;
 				}
 				if (c->type == ID(BUF)) {
 					RTLIL::SigSig conn;
-					RTLIL::IdString name_y = remap_name(c->getPort(ID::Y).as_wire()->name);
-					RTLIL::IdString name_a = remap_name(c->getPort(ID::A).as_wire()->name);
-					conn.first = module->wire(name_y);
-					conn.second = module->wire(name_a);
+					conn.first = mapped_wires.at(c->getPort(ID::Y).as_wire());
+					conn.second = mapped_wires.at(c->getPort(ID::A).as_wire());
 					module->connect(conn);
 					continue;
 				}
@@ -1167,8 +1168,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), ID($_NOT_));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1177,8 +1177,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), stringf("$_%s_", c->type.c_str()+1));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1187,8 +1186,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), stringf("$_%s_", c->type.c_str()+1));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::S, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1197,8 +1195,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), ID($_MUX4_));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::C, ID::D, ID::S, ID::T, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1207,8 +1204,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), ID($_MUX8_));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::C, ID::D, ID::E, ID::F, ID::G, ID::H, ID::S, ID::T, ID::U, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1218,8 +1214,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::C, ID::D, ID::E, ID::F, ID::G, ID::H, ID::I, ID::J, ID::K,
 							ID::L, ID::M, ID::N, ID::O, ID::P, ID::S, ID::T, ID::U, ID::V, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1228,8 +1223,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), stringf("$_%s_", c->type.c_str()+1));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::C, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1238,8 +1232,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					RTLIL::Cell *cell = module->addCell(remap_name(c->name), stringf("$_%s_", c->type.c_str()+1));
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					for (auto name : {ID::A, ID::B, ID::C, ID::D, ID::Y}) {
-						RTLIL::IdString remapped_name = remap_name(c->getPort(name).as_wire()->name);
-						cell->setPort(name, module->wire(remapped_name));
+						cell->setPort(name, mapped_wires.at(c->getPort(name).as_wire()));
 					}
 					design->select(module, cell);
 					continue;
@@ -1277,8 +1270,8 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 						ff.sig_srst = srst_sig;
 						ff.val_srst = init;
 					}
-					ff.sig_d = module->wire(remap_name(c->getPort(ID::D).as_wire()->name));
-					ff.sig_q = module->wire(remap_name(c->getPort(ID::Q).as_wire()->name));
+					ff.sig_d = mapped_wires.at(c->getPort(ID::D).as_wire());
+					ff.sig_q = mapped_wires.at(c->getPort(ID::Q).as_wire());
 					RTLIL::Cell *cell = ff.emit();
 					if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 					design->select(module, cell);
@@ -1290,7 +1283,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 
 			if (c->type.in(ID(_const0_), ID(_const1_))) {
 				RTLIL::SigSig conn;
-				conn.first = module->wire(remap_name(c->connections().begin()->second.as_wire()->name));
+				conn.first = mapped_wires.at(c->connections().begin()->second.as_wire());
 				conn.second = RTLIL::SigSpec(c->type == ID(_const0_) ? 0 : 1, 1);
 				module->connect(conn);
 				continue;
@@ -1326,8 +1319,8 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					ff.sig_srst = srst_sig;
 					ff.val_srst = init;
 				}
-				ff.sig_d = module->wire(remap_name(c->getPort(ID::D).as_wire()->name));
-				ff.sig_q = module->wire(remap_name(c->getPort(ID::Q).as_wire()->name));
+				ff.sig_d = mapped_wires.at(c->getPort(ID::D).as_wire());
+				ff.sig_q = mapped_wires.at(c->getPort(ID::Q).as_wire());
 				RTLIL::Cell *cell = ff.emit();
 				if (markgroups) cell->attributes[ID::abcgroup] = map_autoidx;
 				design->select(module, cell);
@@ -1335,8 +1328,8 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 			}
 
 			if (c->type == ID($lut) && GetSize(c->getPort(ID::A)) == 1 && c->getParam(ID::LUT).as_int() == 2) {
-				SigSpec my_a = module->wire(remap_name(c->getPort(ID::A).as_wire()->name));
-				SigSpec my_y = module->wire(remap_name(c->getPort(ID::Y).as_wire()->name));
+				SigSpec my_a = mapped_wires.at(c->getPort(ID::A).as_wire());
+				SigSpec my_y = mapped_wires.at(c->getPort(ID::Y).as_wire());
 				module->connect(my_y, my_a);
 				continue;
 			}
@@ -1350,7 +1343,7 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 					if (c.width == 0)
 						continue;
 					log_assert(c.width == 1);
-					newsig.append(module->wire(remap_name(c.wire->name)));
+					newsig.append(mapped_wires.at(c.wire));
 				}
 				cell->setPort(conn.first, newsig);
 			}
@@ -1359,9 +1352,9 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 
 		for (auto conn : mapped_mod->connections()) {
 			if (!conn.first.is_fully_const())
-				conn.first = module->wire(remap_name(conn.first.as_wire()->name));
+				conn.first = mapped_wires.at(conn.first.as_wire());
 			if (!conn.second.is_fully_const())
-				conn.second = module->wire(remap_name(conn.second.as_wire()->name));
+				conn.second = mapped_wires.at(conn.second.as_wire());
 			module->connect(conn);
 		}
 
@@ -20,6 +20,7 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/macc.h"
+#include "kernel/sta.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -113,11 +114,13 @@ struct AlumaccWorker
 	dict<RTLIL::SigSpec, maccnode_t*> sig_macc;
 	dict<RTLIL::SigSig, pool<alunode_t*, hash_ptr_ops>> sig_alu;
 	int macc_counter, alu_counter;
+	StaEngine *sta;
 
 	AlumaccWorker(RTLIL::Module *module) : module(module), sigmap(module)
 	{
 		macc_counter = 0;
 		alu_counter = 0;
+		sta = nullptr;
 	}
 
 	void count_bit_users()
@@ -222,6 +225,40 @@ struct AlumaccWorker
 		return acc_shift > width;
 	}
 
+	bool merge_meets_timing(maccnode_t *n, int port_idx, maccnode_t *other_n)
+	{
+		Macc merged;
+		merged.bit_ports = n->macc.bit_ports;
+		merged.bit_ports.append(other_n->macc.bit_ports);
+		for (int i = 0; i < GetSize(n->macc.ports); i++)
+			if (i != port_idx)
+				merged.ports.push_back(n->macc.ports[i]);
+		for (auto &port : other_n->macc.ports)
+			merged.ports.push_back(port);
+
+		int arrival = 0;
+		for (auto bit : merged.bit_ports)
+			arrival = max(arrival, sta->arrival_of(bit));
+		for (auto &port : merged.ports) {
+			for (auto bit : port.in_a)
+				arrival = max(arrival, sta->arrival_of(bit));
+			for (auto bit : port.in_b)
+				arrival = max(arrival, sta->arrival_of(bit));
+		}
+		arrival += StaEngine::estimate_macc_delay(merged, GetSize(n->y));
+
+		int required = INT_MAX;
+		for (auto bit : n->y)
+			required = min(required, sta->required_of(bit));
+
+		if (arrival <= required)
+			return true;
+
+		log("  not merging $macc model for %s into %s: estimated arrival %d exceeds required time %d.\n",
+				log_id(other_n->cell), log_id(n->cell), arrival, required);
+		return false;
+	}
+
 	void merge_macc()
 	{
 		while (1)
@@ -250,6 +287,9 @@ struct AlumaccWorker
 					if (GetSize(other_n->y) != GetSize(n->y) && macc_may_overflow(other_n->macc, GetSize(other_n->y), port.is_signed))
 						continue;
 
+					if (sta != nullptr && !merge_meets_timing(n, i, other_n))
+						continue;
+
 					log("  merging $macc model for %s into %s.\n", log_id(other_n->cell), log_id(n->cell));
 
 					bool do_subtract = port.do_subtract;
@@ -532,10 +572,21 @@ struct AlumaccWorker
 		sig_alu.clear();
 	}
 
-	void run()
+	void run(bool timing)
 	{
 		log("Extracting $alu and $macc cells in module %s:\n", log_id(module));
 
+		StaEngine module_sta(module);
+		int depth_before = 0;
+
+		if (timing) {
+			module_sta.estimate_delays = true;
+			module_sta.setup();
+			module_sta.run();
+			depth_before = module_sta.worst_arrival();
+			sta = &module_sta;
+		}
+
 		count_bit_users();
 		extract_macc();
 		merge_macc();
@@ -545,6 +596,13 @@ struct AlumaccWorker
 		replace_alu();
 
 		log("  created %d $alu and %d $macc cells.\n", alu_counter, macc_counter);
+
+		if (timing) {
+			module_sta.setup();
+			module_sta.run();
+			log("  estimated worst depth: %d before, %d after.\n", depth_before, module_sta.worst_arrival());
+			sta = nullptr;
+		}
 	}
 };
 
@@ -554,22 +612,30 @@ struct AlumaccPass : public Pass {
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("    alumacc [selection]\n");
+		log("    alumacc [options] [selection]\n");
 		log("\n");
 		log("This pass translates arithmetic operations like $add, $mul, $lt, etc. to $alu\n");
 		log("and $macc cells.\n");
 		log("\n");
+		log("    -timing\n");
+		log("        Keep an addition or multiplication in its own cell instead of folding\n");
+		log("        it into the $macc cell that consumes its result, if the wider $macc\n");
+		log("        would produce its output after the required time. Times are rough\n");
+		log("        estimates for built-in cells, as in 'sta'.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing ALUMACC pass (create $alu and $macc cells).\n");
 
+		bool timing = false;
+
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
-			// if (args[argidx] == "-foobar") {
-			// 	foobar_mode = true;
-			// 	continue;
-			// }
+			if (args[argidx] == "-timing") {
+				timing = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -577,7 +643,7 @@ struct AlumaccPass : public Pass {
 		for (auto mod : design->selected_modules())
 			if (!mod->has_processes_warn()) {
 				AlumaccWorker worker(mod);
-				worker.run();
+				worker.run(timing);
 			}
 	}
 } AlumaccPass;
@@ -28,29 +28,36 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
-IdString concat_name(RTLIL::Cell *cell, IdString object_name)
+// Flattened names are made of a prefix that only depends on the instance and
+// a suffix that only depends on the object in the template, so that the
+// suffixes can be computed once per template.
+std::string name_prefix(RTLIL::Cell *cell, bool public_object)
+{
+	if (public_object)
+		return cell->name.str();
+	return "$flatten" + cell->name.str();
+}
+
+std::string name_suffix(IdString object_name)
 {
+	std::string object_name_str = object_name.str();
 	if (object_name[0] == '\\')
-		return stringf("%s.%s", cell->name.c_str(), object_name.c_str() + 1);
-	else {
-		std::string object_name_str = object_name.str();
-		if (object_name_str.substr(0, 8) == "$flatten")
-			object_name_str.erase(0, 8);
-		return stringf("$flatten%s.%s", cell->name.c_str(), object_name_str.c_str());
-	}
+		object_name_str.erase(0, 1);
+	else if (object_name_str.compare(0, 8, "$flatten") == 0)
+		object_name_str.erase(0, 8);
+	return "." + object_name_str;
 }
 
-template<class T>
-IdString map_name(RTLIL::Cell *cell, T *object)
+IdString concat_name(RTLIL::Cell *cell, IdString object_name)
 {
-	return cell->module->uniquify(concat_name(cell, object->name));
+	return name_prefix(cell, object_name[0] == '\\') + name_suffix(object_name);
 }
 
 template<class T>
-void map_attributes(RTLIL::Cell *cell, T *object, IdString orig_object_name)
+void map_attributes(RTLIL::Cell *cell, const pool<std::string> &cell_src, T *object, IdString orig_object_name)
 {
 	if (object->has_attribute(ID::src))
-		object->add_strpool_attribute(ID::src, cell->get_strpool_attribute(ID::src));
+		object->add_strpool_attribute(ID::src, cell_src);
 
 	// Preserve original names via the hdlname attribute, but only for objects with a fully public name.
 	if (cell->name[0] == '\\' && (object->has_attribute(ID::hdlname) || orig_object_name[0] == '\\')) {
@@ -73,31 +80,90 @@ void map_sigspec(const dict<RTLIL::Wire*, RTLIL::Wire*> &map, RTLIL::SigSpec &si
 	sig = chunks;
 }
 
+// Everything about a template that does not depend on the instance being
+// flattened, computed once per template. With a partial selection a template
+// can be instantiated before it is flattened itself, so flatten_module()
+// drops the entry of every module it changes.
+struct FlattenTemplate
+{
+	dict<IdString, IdString> positional_ports;
+	pool<SigBit> driven;
+	dict<IdString, std::string> suffixes;
+	std::vector<RTLIL::Wire*> wires;
+	std::vector<RTLIL::Cell*> cells;
+
+	FlattenTemplate(RTLIL::Module *tpl)
+	{
+		wires = tpl->wires();
+		cells = tpl->cells();
+
+		for (auto tpl_wire : wires) {
+			if (tpl_wire->port_id > 0)
+				positional_ports.emplace(stringf("$%d", tpl_wire->port_id), tpl_wire->name);
+			suffixes[tpl_wire->name] = name_suffix(tpl_wire->name);
+		}
+		for (auto tpl_cell : cells)
+			suffixes[tpl_cell->name] = name_suffix(tpl_cell->name);
+		for (auto &it : tpl->memories)
+			suffixes[it.first] = name_suffix(it.first);
+		for (auto &it : tpl->processes)
+			suffixes[it.first] = name_suffix(it.first);
+
+		for (auto tpl_cell : cells)
+			for (auto &tpl_conn : tpl_cell->connections())
+				if (tpl_cell->output(tpl_conn.first))
+					for (auto bit : tpl_conn.second)
+						driven.insert(bit);
+		for (auto &tpl_conn : tpl->connections())
+			for (auto bit : tpl_conn.first)
+				driven.insert(bit);
+	}
+};
+
 struct FlattenWorker
 {
 	bool ignore_wb = false;
+	dict<RTLIL::Module*, std::unique_ptr<FlattenTemplate>> templates;
+
+	FlattenTemplate &get_template(RTLIL::Module *tpl)
+	{
+		auto &entry = templates[tpl];
+		if (entry == nullptr)
+			entry.reset(new FlattenTemplate(tpl));
+		return *entry;
+	}
 
 	void flatten_cell(RTLIL::Design *design, RTLIL::Module *module, RTLIL::Cell *cell, RTLIL::Module *tpl, SigMap &sigmap, std::vector<RTLIL::Cell*> &new_cells)
 	{
+		FlattenTemplate &tpl_info = get_template(tpl);
+		pool<std::string> cell_src = cell->get_strpool_attribute(ID::src);
+		std::string public_prefix = name_prefix(cell, true), private_prefix = name_prefix(cell, false);
+
+		auto flat_name = [&](IdString object_name) -> IdString {
+			const std::string &prefix = object_name[0] == '\\' ? public_prefix : private_prefix;
+			return prefix + tpl_info.suffixes.at(object_name);
+		};
+		auto map_name = [&](IdString object_name) {
+			return module->uniquify(flat_name(object_name));
+		};
+
 		// Copy the contents of the flattened cell
 
 		dict<IdString, IdString> memory_map;
 		for (auto &tpl_memory_it : tpl->memories) {
-			RTLIL::Memory *new_memory = module->addMemory(map_name(cell, tpl_memory_it.second), tpl_memory_it.second);
-			map_attributes(cell, new_memory, tpl_memory_it.second->name);
+			RTLIL::Memory *new_memory = module->addMemory(map_name(tpl_memory_it.first), tpl_memory_it.second);
+			map_attributes(cell, cell_src, new_memory, tpl_memory_it.second->name);
 			memory_map[tpl_memory_it.first] = new_memory->name;
 			design->select(module, new_memory);
 		}
 
 		dict<RTLIL::Wire*, RTLIL::Wire*> wire_map;
-		dict<IdString, IdString> positional_ports;
-		for (auto tpl_wire : tpl->wires()) {
-			if (tpl_wire->port_id > 0)
-				positional_ports.emplace(stringf("$%d", tpl_wire->port_id), tpl_wire->name);
-
+		wire_map.reserve(GetSize(tpl_info.wires));
+		for (auto tpl_wire : tpl_info.wires) {
 			RTLIL::Wire *new_wire = nullptr;
+			IdString new_name = flat_name(tpl_wire->name);
 			if (tpl_wire->name[0] == '\\') {
-				RTLIL::Wire *hier_wire = module->wire(concat_name(cell, tpl_wire->name));
+				RTLIL::Wire *hier_wire = module->wire(new_name);
 				if (hier_wire != nullptr && hier_wire->get_bool_attribute(ID::hierconn)) {
 					hier_wire->attributes.erase(ID::hierconn);
 					if (GetSize(hier_wire) < GetSize(tpl_wire)) {
@@ -109,19 +175,19 @@ struct FlattenWorker
 				}
 			}
 			if (new_wire == nullptr) {
-				new_wire = module->addWire(map_name(cell, tpl_wire), tpl_wire);
+				new_wire = module->addWire(module->uniquify(new_name), tpl_wire);
 				new_wire->port_input = new_wire->port_output = false;
 				new_wire->port_id = false;
 			}
 
-			map_attributes(cell, new_wire, tpl_wire->name);
+			map_attributes(cell, cell_src, new_wire, tpl_wire->name);
 			wire_map[tpl_wire] = new_wire;
 			design->select(module, new_wire);
 		}
 
 		for (auto &tpl_proc_it : tpl->processes) {
-			RTLIL::Process *new_proc = module->addProcess(map_name(cell, tpl_proc_it.second), tpl_proc_it.second);
-			map_attributes(cell, new_proc, tpl_proc_it.second->name);
+			RTLIL::Process *new_proc = module->addProcess(map_name(tpl_proc_it.first), tpl_proc_it.second);
+			map_attributes(cell, cell_src, new_proc, tpl_proc_it.second->name);
 			for (auto new_proc_sync : new_proc->syncs)
 				for (auto &memwr_action : new_proc_sync->mem_write_actions)
 					memwr_action.memid = memory_map.at(memwr_action.memid).str();
@@ -130,9 +196,9 @@ struct FlattenWorker
 			design->select(module, new_proc);
 		}
 
-		for (auto tpl_cell : tpl->cells()) {
-			RTLIL::Cell *new_cell = module->addCell(map_name(cell, tpl_cell), tpl_cell);
-			map_attributes(cell, new_cell, tpl_cell->name);
+		for (auto tpl_cell : tpl_info.cells) {
+			RTLIL::Cell *new_cell = module->addCell(map_name(tpl_cell->name), tpl_cell);
+			map_attributes(cell, cell_src, new_cell, tpl_cell->name);
 			if (new_cell->has_memid()) {
 				IdString memid = new_cell->getParam(ID::MEMID).decode_string();
 				new_cell->setParam(ID::MEMID, Const(memory_map.at(memid).str()));
@@ -155,21 +221,11 @@ struct FlattenWorker
 
 		// Attach port connections of the flattened cell
 
-		pool<SigBit> tpl_driven;
-		for (auto tpl_cell : tpl->cells())
-			for (auto &tpl_conn : tpl_cell->connections())
-				if (tpl_cell->output(tpl_conn.first))
-					for (auto bit : tpl_conn.second)
-						tpl_driven.insert(bit);
-		for (auto &tpl_conn : tpl->connections())
-			for (auto bit : tpl_conn.first)
-				tpl_driven.insert(bit);
-
 		for (auto &port_it : cell->connections())
 		{
 			IdString port_name = port_it.first;
-			if (positional_ports.count(port_name) > 0)
-				port_name = positional_ports.at(port_name);
+			if (tpl_info.positional_ports.count(port_name) > 0)
+				port_name = tpl_info.positional_ports.at(port_name);
 			if (tpl->wire(port_name) == nullptr || tpl->wire(port_name)->port_id == 0) {
 				if (port_name.begins_with("$"))
 					log_error("Can't map port `%s' of cell `%s' to template `%s'!\n",
@@ -194,7 +250,7 @@ struct FlattenWorker
 			} else {
 				SigSpec sig_tpl = tpl_wire, sig_mod = port_it.second;
 				for (int i = 0; i < GetSize(sig_tpl) && i < GetSize(sig_mod); i++) {
-					if (tpl_driven.count(sig_tpl[i])) {
+					if (tpl_info.driven.count(sig_tpl[i])) {
 						new_conn.first.append(sig_mod[i]);
 						new_conn.second.append(sig_tpl[i]);
 					} else {
@@ -228,8 +284,23 @@ struct FlattenWorker
 		if (!design->selected(module) || module->get_blackbox_attribute(ignore_wb))
 			return;
 
+		templates.erase(module);
+
 		SigMap sigmap(module);
 		std::vector<RTLIL::Cell*> worklist = module->selected_cells();
+
+		// Make room for the contents of all instances up front, instead of
+		// growing the tables of the module instance by instance
+		int num_wires = GetSize(module->wires_), num_cells = GetSize(module->cells_);
+		for (auto cell : worklist) {
+			RTLIL::Module *tpl = design->module(cell->type);
+			if (tpl != nullptr && !tpl->get_blackbox_attribute(ignore_wb)) {
+				num_wires += GetSize(tpl->wires_);
+				num_cells += GetSize(tpl->cells_);
+			}
+		}
+		module->wires_.reserve(num_wires);
+		module->cells_.reserve(num_cells);
 		while (!worklist.empty())
 		{
 			RTLIL::Cell *cell = worklist.back();
@@ -254,6 +325,8 @@ struct FlattenWorker
 			// individual modules, this isn't the case, and the newly added cells might have to be flattened further.
 			flatten_cell(design, module, cell, tpl, sigmap, worklist);
 		}
+
+		templates.erase(module);
 	}
 };
 
@@ -19,6 +19,8 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
+#include "kernel/cost.h"
+#include "kernel/sta.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -36,9 +38,9 @@ struct MuxcoverWorker
 
 	struct newmux_t
 	{
-		int cost;
+		int cost, arrival;
 		vector<SigBit> inputs, selects;
-		newmux_t() : cost(0) {}
+		newmux_t() : cost(0), arrival(0) {}
 	};
 
 	struct tree_t
@@ -66,6 +68,9 @@ struct MuxcoverWorker
 	int cost_mux8;
 	int cost_mux16;
 
+	StaEngine *sta;
+	int delay_mux2;
+
 	MuxcoverWorker(Module *module) : module(module), sigmap(module)
 	{
 		use_mux4 = false;
@@ -79,6 +84,8 @@ struct MuxcoverWorker
 		cost_mux8 = COST_MUX8;
 		cost_mux16 = COST_MUX16;
 		decode_mux_counter = 0;
+		sta = nullptr;
+		delay_mux2 = CellCosts::default_gate_cost().at(ID($_MUX_));
 	}
 
 	bool xcmp(std::initializer_list<SigBit> list)
@@ -225,6 +232,38 @@ struct MuxcoverWorker
 		std::get<2>(entry) = true;
 	}
 
+	int select_arrival(SigBit bit)
+	{
+		if (bit == State::Sx)
+			return 0;
+
+		auto it = decode_mux_reverse_cache.find(bit);
+		if (it == decode_mux_reverse_cache.end())
+			return max(0, sta->arrival_of(bit));
+
+		const auto &key = it->second;
+		return max(max(select_arrival(std::get<0>(key)), select_arrival(std::get<1>(key))),
+				select_arrival(std::get<2>(key))) + delay_mux2;
+	}
+
+	// Estimated arrival time at the output of a new mux, or -1 if it is later
+	// than the required time of the mux tree at that point
+	int mux_arrival(tree_t &tree, const newmux_t &mux, SigBit bit)
+	{
+		int arrival = 0;
+		for (auto inbit : mux.inputs)
+			arrival = max(arrival, tree.newmuxes.at(inbit).arrival);
+		for (auto selbit : mux.selects)
+			arrival = max(arrival, select_arrival(selbit));
+		arrival += ceil_log2(GetSize(mux.inputs)) * delay_mux2;
+
+		if (GetSize(mux.inputs) > 2 && arrival > sta->required_of(bit)) {
+			log_debug("        Estimated arrival %d exceeds required time %d.\n", arrival, sta->required_of(bit));
+			return -1;
+		}
+		return arrival;
+	}
+
 	void find_best_covers(tree_t &tree, const vector<SigBit> &bits)
 	{
 		for (auto bit : bits)
@@ -278,6 +317,9 @@ struct MuxcoverWorker
 			mux.cost += cost_mux2;
 			mux.cost += sum_best_covers(tree, mux.inputs);
 
+			if (sta != nullptr)
+				mux.arrival = mux_arrival(tree, mux, bit);
+
 			log_debug("      Cost of mux2 at %s: %d\n", log_signal(bit), mux.cost);
 
 			best_mux = mux;
@@ -322,7 +364,10 @@ struct MuxcoverWorker
 
 				log_debug("      Cost of mux4 at %s: %d\n", log_signal(bit), mux.cost);
 
-				if (best_mux.cost >= mux.cost)
+				if (sta != nullptr)
+					mux.arrival = mux_arrival(tree, mux, bit);
+
+				if (best_mux.cost >= mux.cost && mux.arrival >= 0)
 					best_mux = mux;
 			}
 		}
@@ -387,7 +432,10 @@ struct MuxcoverWorker
 
 				log_debug("      Cost of mux8 at %s: %d\n", log_signal(bit), mux.cost);
 
-				if (best_mux.cost >= mux.cost)
+				if (sta != nullptr)
+					mux.arrival = mux_arrival(tree, mux, bit);
+
+				if (best_mux.cost >= mux.cost && mux.arrival >= 0)
 					best_mux = mux;
 			}
 		}
@@ -489,11 +537,17 @@ struct MuxcoverWorker
 
 				log_debug("      Cost of mux16 at %s: %d\n", log_signal(bit), mux.cost);
 
-				if (best_mux.cost >= mux.cost)
+				if (sta != nullptr)
+					mux.arrival = mux_arrival(tree, mux, bit);
+
+				if (best_mux.cost >= mux.cost && mux.arrival >= 0)
 					best_mux = mux;
 			}
 		}
 
+		if (sta != nullptr && best_mux.inputs.empty())
+			best_mux.arrival = max(0, sta->arrival_of(bit));
+
 		tree.newmuxes[bit] = best_mux;
 		return best_mux.cost;
 	}
@@ -594,10 +648,21 @@ struct MuxcoverWorker
 			module->remove(it.second);
 	}
 
-	void run()
+	void run(bool timing)
 	{
 		log("Covering MUX trees in module %s..\n", log_id(module));
 
+		StaEngine module_sta(module);
+		int depth_before = 0;
+
+		if (timing) {
+			module_sta.estimate_delays = true;
+			module_sta.setup();
+			module_sta.run();
+			depth_before = module_sta.worst_arrival();
+			sta = &module_sta;
+		}
+
 		treeify();
 
 		log("  Covering trees:\n");
@@ -615,6 +680,13 @@ struct MuxcoverWorker
 
 		if (!nodecode)
 			log("  Added a total of %d decoder MUXes.\n", decode_mux_counter);
+
+		if (timing) {
+			module_sta.setup();
+			module_sta.run();
+			log("  Estimated worst depth: %d before, %d after.\n", depth_before, module_sta.worst_arrival());
+			sta = nullptr;
+		}
 	}
 };
 
@@ -652,6 +724,12 @@ struct MuxcoverPass : public Pass {
 		log("        Do not consider mappings that use $_MUX<N>_ to select from less\n");
 		log("        than <N> different signals.\n");
 		log("\n");
+		log("    -timing\n");
+		log("        Only cover a part of a $_MUX_ tree with a $_MUX4_, $_MUX8_ or\n");
+		log("        $_MUX16_ cell if the select signals, including any decoder logic,\n");
+		log("        still reach its output before the required time of the tree at that\n");
+		log("        point. Otherwise $_MUX_ cells are kept there.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -662,6 +740,7 @@ struct MuxcoverPass : public Pass {
 		bool use_mux16 = false;
 		bool nodecode = false;
 		bool nopartial = false;
+		bool timing = false;
 		int cost_dmux = COST_DMUX;
 		int cost_mux2 = COST_MUX2;
 		int cost_mux4 = COST_MUX4;
@@ -712,6 +791,10 @@ struct MuxcoverPass : public Pass {
 				nopartial = true;
 				continue;
 			}
+			if (arg == "-timing") {
+				timing = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -735,7 +818,7 @@ struct MuxcoverPass : public Pass {
 			worker.cost_mux16 = cost_mux16;
 			worker.nodecode = nodecode;
 			worker.nopartial = nopartial;
-			worker.run();
+			worker.run(timing);
 		}
 	}
 } MuxcoverPass;
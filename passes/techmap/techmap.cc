@@ -22,6 +22,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/ffinit.h"
 #include "libs/sha1/sha1.h"
+#include "frontends/verilog/preproc.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -975,6 +976,51 @@ struct TechmapWorker
 
 struct TechmapPass : public Pass {
 	TechmapPass() : Pass("techmap", "generic technology mapper") { }
+
+	dict<std::string, RTLIL::Design*> map_cache;
+
+	static std::string join_map_files(const std::vector<std::string> &map_files)
+	{
+		std::string str;
+		for (auto &fn : map_files)
+			str += (str.empty() ? "" : " ") + fn;
+		return str;
+	}
+
+	// Returns an empty string if the map files can't be cached (saved designs,
+	// files that can't be hashed, e.g. glob patterns, files that `include other
+	// files, or while global defines are set with verilog_defines).
+	static std::string map_cache_key(RTLIL::Design *design, const std::vector<std::string> &map_files, const std::string &verilog_frontend)
+	{
+		if (!design->verilog_defines->defines.empty())
+			return std::string();
+
+		std::string key = verilog_frontend;
+		for (auto fn : map_files) {
+			if (fn.compare(0, 1, "%") == 0)
+				return std::string();
+			rewrite_filename(fn);
+			std::ifstream f(fn, std::ios::binary);
+			if (f.fail())
+				return std::string();
+			std::stringstream buffer;
+			buffer << f.rdbuf();
+			std::string content = buffer.str();
+			if (content.find("`include") != std::string::npos)
+				return std::string();
+			SHA1 sha1;
+			sha1.update(content);
+			key += stringf("\n%s %s", fn.c_str(), sha1.final().c_str());
+		}
+		return key;
+	}
+
+	void on_shutdown() override
+	{
+		for (auto &it : map_cache)
+			delete it.second;
+		map_cache.clear();
+	}
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -1013,6 +1059,14 @@ struct TechmapPass : public Pass {
 		log("    -wb\n");
 		log("        Ignore the 'whitebox' attribute on cell implementations.\n");
 		log("\n");
+		log("    -nocache\n");
+		log("        Always re-read the map files. By default the elaborated map design is\n");
+		log("        cached for the lifetime of the process, keyed on the contents of the\n");
+		log("        map files and the frontend options, so that repeated techmap calls\n");
+		log("        with the same map files (as issued by the synth_* scripts) do not parse\n");
+		log("        them again. Map files that use `include and techmap calls made while\n");
+		log("        defines are set with verilog_defines are never cached.\n");
+		log("\n");
 		log("    -assert\n");
 		log("        this option will cause techmap to exit with an error if it can't map\n");
 		log("        a selected cell. only cell types that end on an underscore are accepted\n");
@@ -1152,6 +1206,7 @@ struct TechmapPass : public Pass {
 		std::vector<std::string> map_files;
 		std::string verilog_frontend = "verilog -nooverwrite -noblackbox";
 		int max_iter = -1;
+		bool nocache = false;
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
@@ -1191,13 +1246,24 @@ struct TechmapPass : public Pass {
 				worker.ignore_wb = true;
 				continue;
 			}
+			if (args[argidx] == "-nocache") {
+				nocache = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
+		if (map_files.empty())
+			map_files.push_back("+/techmap.v");
+
+		std::string cache_key = nocache ? std::string() : map_cache_key(design, map_files, verilog_frontend);
 		RTLIL::Design *map = new RTLIL::Design;
-		if (map_files.empty()) {
-			Frontend::frontend_call(map, nullptr, "+/techmap.v", verilog_frontend);
+
+		if (!cache_key.empty() && map_cache.count(cache_key)) {
+			log("Using cached map design for %s.\n", join_map_files(map_files).c_str());
+			for (auto mod : map_cache.at(cache_key)->modules())
+				map->add(mod->clone());
 		} else {
 			for (auto &fn : map_files)
 				if (fn.compare(0, 1, "%") == 0) {
@@ -1211,6 +1277,12 @@ struct TechmapPass : public Pass {
 				} else {
 					Frontend::frontend_call(map, nullptr, fn, (fn.size() > 3 && fn.compare(fn.size()-3, std::string::npos, ".il") == 0 ? "rtlil" : verilog_frontend));
 				}
+			if (!cache_key.empty()) {
+				RTLIL::Design *cached = new RTLIL::Design;
+				for (auto mod : map->modules())
+					cached->add(mod->clone());
+				map_cache[cache_key] = cached;
+			}
 		}
 
 		log_header(design, "Continuing TECHMAP pass.\n");
@@ -31,7 +31,7 @@ end
 
 import json
 import argparse
-import sys, socket, os, subprocess
+import sys, socket, os, subprocess, tempfile, atexit
 try:
 	import msvcrt, win32pipe, win32file
 except ImportError:
@@ -51,20 +51,35 @@ def map_parameter(parameter):
 	if parameter["type"] == "real":
 		return float(parameter["value"])
 
+transfer = "json"
+
+def source_response(frontend, source):
+	if transfer == "raw":
+		return json.dumps({"frontend": frontend, "source_length": len(source.encode("utf-8"))}) + "\n" + source
+	if transfer == "path":
+		fd, path = tempfile.mkstemp(suffix=".il", dir="/dev/shm" if os.path.isdir("/dev/shm") else None)
+		atexit.register(os.unlink, path)
+		with os.fdopen(fd, "w") as f:
+			f.write(source)
+		return json.dumps({"frontend": frontend, "source_path": path}) + "\n"
+	return json.dumps({"frontend": frontend, "source": source}) + "\n"
+
 def call(input_json):
 	input = json.loads(input_json)
 	if input["method"] == "modules":
-		return json.dumps({"modules": modules()})
+		return json.dumps({"modules": modules()}) + "\n"
 	if input["method"] == "derive":
 		try:
 			frontend, source = derive(input["module"],
 				{name: map_parameter(value) for name, value in input["parameters"].items()})
-			return json.dumps({"frontend": frontend, "source": source})
+			return source_response(frontend, source)
 		except ValueError as e:
-			return json.dumps({"error": str(e)})
+			return json.dumps({"error": str(e)}) + "\n"
 
 def main():
+	global transfer
 	parser = argparse.ArgumentParser()
+	parser.add_argument("--transfer", choices=["json", "raw", "path"], default="json")
 	modes = parser.add_subparsers(dest="mode")
 	mode_stdio = modes.add_parser("stdio")
 	if os.name == "posix":
@@ -73,12 +88,13 @@ def main():
 		mode_path = modes.add_parser("named-pipe")
 	mode_path.add_argument("path")
 	args = parser.parse_args()
+	transfer = args.transfer
 
 	if args.mode == "stdio":
 		while True:
 			input = sys.stdin.readline()
 			if not input: break
-			sys.stdout.write(call(input) + "\n")
+			sys.stdout.write(call(input))
 			sys.stdout.flush()
 
 	if args.mode == "unix-socket":
@@ -93,7 +109,7 @@ def main():
 			while True:
 				input = file.readline()
 				if not input: break
-				file.write(call(input) + "\n")
+				file.write(call(input))
 				file.flush()
 			ys_proc.wait(timeout=10)
 			if ys_proc.returncode:
@@ -116,7 +132,7 @@ def main():
 					assert result == 0
 					input += data
 					assert not b"\n" in input or input.endswith(b"\n")
-				output = (call(input.decode("utf-8")) + "\n").encode("utf-8")
+				output = call(input.decode("utf-8")).encode("utf-8")
 				length = len(output)
 				while length > 0:
 					result, done = win32file.WriteFile(pipe, output)
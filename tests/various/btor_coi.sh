@@ -0,0 +1,27 @@
+#!/bin/bash
+set -ex
+mkdir -p temp
+
+cat > temp/btor_coi.v << "EOT"
+module top(input clk, input [7:0] a, b, c, output [11:0] x, y, output [15:0] p);
+	assign x = {b, a[3:0]};
+	assign y = {c, a[3:0]};
+	assign p = a * b;
+	reg [7:0] cnt = 0;
+	always @(posedge clk)
+		cnt <= cnt + a;
+	always @*
+		assert (cnt != 8'hff);
+endmodule
+EOT
+
+# the same slice of `a` is emitted only once
+../../yosys -q -p 'read_verilog -formal temp/btor_coi.v; prep; write_btor temp/btor_coi.btor'
+test $(grep -c ' slice ' temp/btor_coi.btor) -eq 1
+grep -q ' mul ' temp/btor_coi.btor
+
+# with -coi, only logic driving the assertion is kept
+../../yosys -q -p 'read_verilog -formal temp/btor_coi.v; prep; write_btor -coi temp/btor_coi.btor'
+test $(grep -c ' output ' temp/btor_coi.btor) -eq 0
+test $(grep -c ' mul ' temp/btor_coi.btor) -eq 0
+grep -q ' bad ' temp/btor_coi.btor
@@ -0,0 +1,89 @@
+#!/bin/bash
+set -ex
+mkdir -p temp
+
+cat > temp/rtlil_fast_in.il << "EOT"
+# hand-written input covering the whole grammar
+autoidx 42
+attribute \top 1
+attribute \src "rtlil_fast.il:1.1-2.3"
+module \top
+  parameter \WIDTH 8
+  parameter \NOVAL
+  attribute \keep 1
+  wire width 8 input 1 \a
+  wire width 8 upto offset 4 signed input 2 \b
+  wire input 3 \clk
+  wire width 8 output 4 \y
+  wire width 4 inout 5 \io
+  wire width 8 \r
+  attribute \note "tab\there \"quoted\" \101 newline\n"
+  memory width 8 size 16 offset 2 \mem
+  cell \myadd $add$rtlil_fast.il:10$1
+    parameter \A_SIGNED 0
+    parameter signed \B_SIGNED 1
+    parameter real \R "1.5"
+    parameter \WIDTH 8
+    connect \A { \a [7:4] \a [3] 3'01x }
+    connect \B \b
+    connect \Y \r
+  end
+  process $proc$rtlil_fast.il:20$2
+    assign \y \r
+    attribute \full_case 1
+    switch \a [1:0]
+      attribute \src "case1"
+      case 2'00 , 2'11
+        assign \y 8'10101010
+      case , 2'01
+        switch \b [0]
+          case 1'1
+            assign \y [3:0] 4'zzzz
+          case
+        end
+      case
+        assign \y 8'-
+    end
+    sync posedge \clk
+      update \io 4'mx10
+      attribute \src "memwr"
+      memwr \mem \a [3:0] \r 8'11111111 1'1
+    sync always
+    sync global
+    sync init
+      update \io 4'0
+    sync low \clk
+    sync high \clk
+    sync edge \clk
+  end
+  connect \io [0] 1'1
+  connect { \io [3:1] } { 1'0 2'10 }
+end
+
+attribute \blackbox 1
+module \bb
+  wire width 3 input 1 \x
+end
+
+attribute \blackbox 1
+module \myadd
+  parameter \WIDTH 8
+  wire width 8 input 1 \A
+  wire width 8 input 2 \B
+  wire width 8 output 3 \Y
+end
+EOT
+
+../../yosys -q -p 'read_rtlil temp/rtlil_fast_in.il; write_rtlil temp/rtlil_fast_ref.il'
+../../yosys -q -p 'read_rtlil -fast temp/rtlil_fast_in.il; write_rtlil temp/rtlil_fast_out.il'
+cmp temp/rtlil_fast_ref.il temp/rtlil_fast_out.il
+
+# round trip a design produced by the Verilog frontend
+../../yosys -q -p 'read_verilog ../simple/memory.v ../simple/fsm.v; write_rtlil temp/rtlil_fast_vlog.il'
+../../yosys -q -p 'read_rtlil temp/rtlil_fast_vlog.il; write_rtlil temp/rtlil_fast_ref.il'
+../../yosys -q -p 'read_rtlil -fast temp/rtlil_fast_vlog.il; write_rtlil temp/rtlil_fast_out.il'
+cmp temp/rtlil_fast_ref.il temp/rtlil_fast_out.il
+
+# errors are reported like in the bison parser
+printf 'module \\m\n  connect \\nx 1\nend\n' > temp/rtlil_fast_err.il
+../../yosys -q -p 'read_rtlil -fast temp/rtlil_fast_err.il' 2>&1 | grep -F 'Parser error in line 2: RTLIL error: wire \nx not found'
@@ -0,0 +1,21 @@
+#!/bin/bash
+set -ex
+rm -rf temp/smt2_split
+mkdir -p temp/smt2_split
+
+../../yosys -q -p 'read_verilog ../simple/hierarchy.v; prep; write_smt2 temp/smt2_split.smt2; write_smt2 -split modules temp/smt2_split/top.smt2'
+
+# inlining the included module files gives back the regular output
+while IFS= read -r line; do
+	case "$line" in
+		"; yosys-smt2-include "*) cat "temp/smt2_split/${line#; yosys-smt2-include }" ;;
+		*) printf '%s\n' "$line" ;;
+	esac
+done < temp/smt2_split/top.smt2 > temp/smt2_split_inlined.smt2
+diff temp/smt2_split.smt2 temp/smt2_split_inlined.smt2
+
+# module files are keyed by their contents and not written again
+test $(ls temp/smt2_split/modules | wc -l) -eq 2
+touch -d '2000-01-01' temp/smt2_split/modules/*.smt2
+../../yosys -q -p 'read_verilog ../simple/hierarchy.v; prep; write_smt2 -split modules temp/smt2_split/top.smt2'
+test -z "$(find temp/smt2_split/modules -newer temp/smt2_split.smt2)"